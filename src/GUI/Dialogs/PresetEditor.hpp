@@ -166,7 +166,7 @@ public:
             "support_material_contact_distance"s, "support_material_buildplate_only"s, "dont_support_bridges"s,
             "notes"s,
             "complete_objects"s, "extruder_clearance_radius"s, "extruder_clearance_height"s,
-            "gcode_comments"s, "output_filename_format"s,
+            "gcode_comments"s, "gcode_binary"s, "output_filename_format"s, "layer_memory_window"s,
             "post_process"s,
             "perimeter_extruder"s, "infill_extruder"s, "solid_infill_extruder"s,
             "support_material_extruder"s, "support_material_interface_extruder"s,
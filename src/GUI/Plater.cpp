@@ -923,18 +923,20 @@ void Plater::object_list_changed() {
 }
 
 void Plater::stop_background_process() {
-    //TODO
+    this->print_job.cancel();
 }
 
 void Plater::start_background_process() {
-    //TODO
+    this->print_job.start();
 }
 
 void Plater::pause_background_process() {
-    //TODO
+    this->print_job.cancel();
 }
 void Plater::resume_background_process() {
-    //TODO
+    // only restart a job which was paused, the valid steps are kept
+    if (this->print_job.status() == PrintJob::pjCanceled)
+        this->print_job.start();
 }
 
 wxMenu* Plater::object_menu() {
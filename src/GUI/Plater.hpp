@@ -15,6 +15,7 @@
 #include "libslic3r.h"
 #include "Model.hpp"
 #include "Print.hpp"
+#include "PrintJob.hpp"
 #include "Config.hpp"
 #include "misc_ui.hpp"
 
@@ -118,6 +119,8 @@ public:
     void show_preset_editor(preset_t preset, unsigned int idx);
 private:
     std::shared_ptr<Slic3r::Print> print {std::make_shared<Print>(Slic3r::Print())};
+    /// Background processing of this->print.
+    Slic3r::PrintJob print_job {this->print.get()};
     std::shared_ptr<Slic3r::Model> model {std::make_shared<Model>(Slic3r::Model())};
 
     std::shared_ptr<Slic3r::Config> config { Slic3r::Config::new_from_defaults(
@@ -1,8 +1,10 @@
 #include "slic3r.hpp"
 #include "Geometry.hpp"
 #include "IO.hpp"
+#include "Log.hpp"
 #include "SLAPrint.hpp"
 #include "Print.hpp"
+#include "Profiler.hpp"
 #include "SimplePrint.hpp"
 #include "TriangleMesh.hpp"
 #include "libslic3r.h"
@@ -10,10 +12,12 @@
 #include <chrono>
 #include <cstdio>
 #include <string>
+#include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <math.h>
+#include <new>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/iostream.hpp>
@@ -25,6 +29,19 @@
 
 using namespace Slic3r;
 
+#ifdef SLIC3R_PROFILE_ALLOCATIONS
+// Count the allocations for --profile-out. This costs an atomic increment per
+// allocation while profiling, so it is only built on demand.
+void* operator new(std::size_t size) {
+    Profiler::count(Profiler::pcAllocations);
+    Profiler::count(Profiler::pcAllocatedBytes, size);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif // SLIC3R_PROFILE_ALLOCATIONS
+
 #ifndef BUILD_TEST
 int
 main(int argc, char **argv) {
@@ -58,7 +75,7 @@ int CLI::run(int argc, char **argv) {
     }
     
     // load config files supplied via --load
-    for (auto const &file : config.getStrings("load")) {
+    for (auto const &file : config.getStrings("load", {})) {
         if (!boost::filesystem::exists(file)) {
             if (config.getBool("ignore_nonexistent_file", false)) {
                 continue;
@@ -95,6 +112,10 @@ int CLI::run(int argc, char **argv) {
         return 1;
     }
     
+    const std::string profile_out = this->config.getString("profile_out", "");
+    if (!profile_out.empty())
+        Profiler::enable();
+    
     // read input file(s) if any
     for (auto const &file : input_files) {
         Model model;
@@ -121,7 +142,7 @@ int CLI::run(int argc, char **argv) {
                 m.merge(model);
             
             // Rearrange instances unless --dont-arrange is supplied
-            if (!this->config.getBool("dont_arrange")) {
+            if (!this->config.getBool("dont_arrange", false)) {
                 m.add_default_instances();
                 const BoundingBoxf bb{ this->full_print_config.bed_shape.values };
                 m.arrange_objects(
@@ -304,9 +325,20 @@ int CLI::run(int argc, char **argv) {
                 SLAPrint print(&model); // initialize print with model
                 print.config.apply(this->print_config, true); // apply configuration
                 print.slice(); // slice file
-                const std::string outfile = this->output_filepath(model, IO::SVG);
-                print.write_svg(outfile); // write SVG
-                boost::nowide::cout << "SVG file exported to " << outfile << std::endl;
+                if (print.config.sla_output_format.value == slaofPNG) {
+                    const std::string outfile = this->output_filepath(model, IO::ZIP);
+                    try {
+                        print.write_png(outfile); // write a zip of PNG images
+                    } catch (std::runtime_error &e) {
+                        boost::nowide::cerr << e.what() << std::endl;
+                        return 1;
+                    }
+                    boost::nowide::cout << "PNG layers exported to " << outfile << std::endl;
+                } else {
+                    const std::string outfile = this->output_filepath(model, IO::SVG);
+                    print.write_svg(outfile); // write SVG
+                    boost::nowide::cout << "SVG file exported to " << outfile << std::endl;
+                }
             }
         } else if (opt_key == "export_gcode") {
             for (const Model &model : this->models) {
@@ -319,10 +351,10 @@ int CLI::run(int argc, char **argv) {
                     boost::nowide::cout << msg << std::endl;
                 };
                 print.apply_config(this->print_config);
-                print.arrange = !this->config.getBool("dont_arrange");
+                print.arrange = !this->config.getBool("dont_arrange", false);
                 print.center = !this->config.has("center")
                     && !this->config.has("align_xy")
-                    && !this->config.getBool("dont_arrange");
+                    && !this->config.getBool("dont_arrange", false);
                 print.set_model(model);
                 
                 // start chronometer
@@ -355,6 +387,19 @@ int CLI::run(int argc, char **argv) {
         }
     }
     
+    if (!profile_out.empty()) {
+        Profiler::disable();
+        slic3r_log->set_level(log_t::INFO);
+        Profiler::report();
+        try {
+            Profiler::write_chrome_trace(profile_out);
+        } catch (std::runtime_error &e) {
+            boost::nowide::cerr << e.what() << std::endl;
+            return 1;
+        }
+        boost::nowide::cout << "Profile written to " << profile_out << std::endl;
+    }
+    
     if (actions.empty()) {
 #ifdef USE_WX
         GUI::App *gui = new GUI::App();
@@ -0,0 +1,305 @@
+/// Benchmark of the slicing pipeline on parametric stress meshes.
+///
+/// Usage: slic3r_benchmark [--case NAME]... [--repeat N] [--threads N]
+///                         [--output results.json] [--baseline baseline.json]
+///                         [--time-tolerance 0.25] [--memory-tolerance 0.25]
+///
+/// Every case is sliced and exported to G-code `repeat` times, the fastest run is
+/// kept. The time of each step comes from the Profiler. The results are written
+/// as JSON; a results file can be used as the baseline of a later run, in which
+/// case the program fails if a case got slower or bigger than the tolerances allow.
+/// Times are compared relative to a fixed calibration workload so that a baseline
+/// stays meaningful on a faster or slower machine. Peak RSS is the one of the whole
+/// process, so run a single case per process to measure it (ctest does).
+
+#include "test_data.hpp"
+#include "libslic3r.h"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+using namespace Slic3r;
+
+namespace {
+
+struct BenchmarkCase {
+    const char* name;
+    std::function<TriangleMesh()> mesh;
+    std::map<std::string, std::string> config;
+};
+
+const std::vector<BenchmarkCase> benchmark_cases {
+    // many facets, every layer a single big loop
+    { "sphere",         []() { return Slic3r::Test::sphere_mesh(25, PI / 100); }, {} },
+    // many holes per layer and many bridges
+    { "lattice",        []() { return Slic3r::Test::lattice_mesh(4, 10, 3); }, {} },
+    // many islands per layer
+    { "island_plate",   []() { return Slic3r::Test::island_plate_mesh(8, 8, 9, 3, 3); }, {} },
+    // many small layers
+    { "tower",          []() { return Slic3r::Test::tower_mesh(5, 100); }, { { "layer_height", "0.1" } } },
+};
+
+/// The time and size of a case.
+struct BenchmarkResult {
+    std::string name;
+    size_t facets = 0, layers = 0, gcode_bytes = 0;
+    double total = 0;                       ///< seconds to slice and export
+    std::map<std::string, double> steps;    ///< seconds spent in each step, without the steps it ran
+    double peak_rss = 0;                    ///< MB
+};
+
+/// Counts the G-code bytes instead of storing them.
+class CountingBuffer : public std::streambuf {
+    public:
+    size_t count = 0;
+    protected:
+    int overflow(int c) override { ++this->count; return c; };
+    std::streamsize xsputn(const char*, std::streamsize n) override { this->count += n; return n; };
+};
+
+double
+peak_rss_mb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1048576.;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    #ifdef __APPLE__
+        return usage.ru_maxrss / 1048576.;  // bytes
+    #else
+        return usage.ru_maxrss / 1024.;     // kilobytes
+    #endif
+#endif
+}
+
+double
+seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/// Seconds taken by a fixed mix of sorting and floating point work, best of three.
+double
+calibrate()
+{
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        const auto t0 = std::chrono::steady_clock::now();
+        std::vector<uint32_t> values(1 << 20);
+        uint32_t seed = 12345;
+        for (uint32_t &value : values)
+            value = seed = seed * 1664525u + 1013904223u;
+        std::sort(values.begin(), values.end());
+        double sum = 0;
+        for (uint32_t value : values)
+            sum += std::sqrt(double(value));
+        const double elapsed = seconds_since(t0);
+        if (sum < 0) std::cout << sum;  // keep the loop
+        best = (run == 0) ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+/// Seconds spent in each step. The steps run the ones they depend on (infill()
+/// runs prepare_infill() and so on), so the time of the steps nested in a span
+/// is taken out of it.
+std::map<std::string, double>
+self_times(const std::vector<Profiler::Span> &spans)
+{
+    std::vector<Profiler::Span> steps;
+    for (const Profiler::Span &span : spans)
+        if (std::string(span.category) == "step")
+            steps.push_back(span);
+
+    std::map<std::string, double> times;
+    for (const Profiler::Span &span : steps) {
+        int64_t self = span.duration;
+        for (const Profiler::Span &inner : steps) {
+            if (&inner == &span || inner.thread != span.thread) continue;
+            if (inner.start < span.start || inner.start + inner.duration > span.start + span.duration) continue;
+            // only the direct children, the grand children are already out of them
+            const bool direct = std::none_of(steps.begin(), steps.end(), [&](const Profiler::Span &middle) {
+                return &middle != &span && &middle != &inner && middle.thread == span.thread
+                    && middle.start >= span.start && middle.start + middle.duration <= span.start + span.duration
+                    && inner.start >= middle.start && inner.start + inner.duration <= middle.start + middle.duration;
+            });
+            if (direct) self -= inner.duration;
+        }
+        times[span.name] += std::max<int64_t>(self, 0) * 1e-6;
+    }
+    return times;
+}
+
+BenchmarkResult
+run_case(const BenchmarkCase &bcase, int repeat, int threads)
+{
+    BenchmarkResult result;
+    result.name = bcase.name;
+    const TriangleMesh mesh = bcase.mesh();
+    result.facets = mesh.facets_count();
+
+    for (int run = 0; run < repeat; ++run) {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("fill_density", 0.2);
+        config->set("skirts", 1);
+        if (threads > 0) config->set("threads", threads);
+        for (const auto &option : bcase.config)
+            config->set(option.first, option.second);
+        Slic3r::Model model;
+        auto print {Slic3r::Test::init_print({ mesh }, model, config)};
+
+        CountingBuffer buffer;
+        std::ostream gcode(&buffer);
+        Profiler::enable();
+        const auto t0 = std::chrono::steady_clock::now();
+        print->export_gcode(gcode, true);
+        const double total = seconds_since(t0);
+        Profiler::disable();
+
+        if (run > 0 && total >= result.total) continue;
+        result.total = total;
+        result.gcode_bytes = buffer.count;
+        result.layers = print->objects.front()->layer_count();
+        result.steps = self_times(Profiler::spans());
+    }
+    result.peak_rss = peak_rss_mb();
+    return result;
+}
+
+void
+write_json(std::ostream &out, double calibration, const std::vector<BenchmarkResult> &results)
+{
+    out << std::setprecision(6)
+        << "{\n    \"calibration\": " << calibration << ",\n    \"cases\": {";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "        \"" << r.name << "\": {\n"
+            << "            \"facets\": " << r.facets << ",\n"
+            << "            \"layers\": " << r.layers << ",\n"
+            << "            \"gcode_bytes\": " << r.gcode_bytes << ",\n"
+            << "            \"seconds\": " << r.total << ",\n"
+            << "            \"relative_time\": " << r.total / calibration << ",\n"
+            << "            \"layers_per_second\": " << r.layers / r.total << ",\n"
+            << "            \"facets_per_second\": " << r.facets / r.total << ",\n"
+            << "            \"peak_rss_mb\": " << r.peak_rss << ",\n"
+            << "            \"steps\": {";
+        bool first = true;
+        for (const auto &step : r.steps) {
+            out << (first ? " " : ", ") << "\"" << step.first << "\": " << step.second;
+            first = false;
+        }
+        out << " }\n        }";
+    }
+    out << "\n    }\n}\n";
+}
+
+/// Returns the number of cases which regressed.
+int
+compare(const std::string &baseline_file, double calibration, const std::vector<BenchmarkResult> &results,
+    double time_tolerance, double memory_tolerance)
+{
+    boost::property_tree::ptree baseline;
+    boost::property_tree::read_json(baseline_file, baseline);
+
+    int regressions = 0;
+    for (const BenchmarkResult &r : results) {
+        const auto base = baseline.get_child_optional("cases." + r.name);
+        if (!base) {
+            std::cout << r.name << ": not in the baseline" << std::endl;
+            continue;
+        }
+        const double time_ratio   = (r.total / calibration) / base->get<double>("relative_time");
+        const double memory_ratio = r.peak_rss / base->get<double>("peak_rss_mb");
+        const bool slower = time_ratio > 1 + time_tolerance;
+        const bool bigger = memory_ratio > 1 + memory_tolerance;
+        std::cout << std::fixed << std::setprecision(2)
+            << r.name << ": time " << time_ratio << "x, peak RSS " << memory_ratio << "x of the baseline"
+            << (slower ? ", TIME REGRESSION" : "") << (bigger ? ", MEMORY REGRESSION" : "") << std::endl;
+        if (slower || bigger) ++regressions;
+    }
+    return regressions;
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+    std::vector<std::string> case_names;
+    std::string output, baseline;
+    int repeat = 3, threads = 0;
+    double time_tolerance = 0.25, memory_tolerance = 0.25;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 2;
+        }
+        const std::string value = argv[++i];
+        if      (arg == "--case")             case_names.push_back(value);
+        else if (arg == "--repeat")           repeat = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--threads")          threads = std::atoi(value.c_str());
+        else if (arg == "--output")           output = value;
+        else if (arg == "--baseline")         baseline = value;
+        else if (arg == "--time-tolerance")   time_tolerance = std::atof(value.c_str());
+        else if (arg == "--memory-tolerance") memory_tolerance = std::atof(value.c_str());
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<const BenchmarkCase*> cases;
+    for (const BenchmarkCase &bcase : benchmark_cases)
+        if (case_names.empty() || std::find(case_names.begin(), case_names.end(), bcase.name) != case_names.end())
+            cases.push_back(&bcase);
+    if (cases.size() < std::max<size_t>(case_names.size(), 1)) {
+        std::cerr << "Unknown benchmark case" << std::endl;
+        return 2;
+    }
+
+    double calibration = calibrate();
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkCase* bcase : cases) {
+        results.push_back(run_case(*bcase, repeat, threads));
+        const BenchmarkResult &r = results.back();
+        std::cout << std::fixed << std::setprecision(3)
+            << r.name << ": " << r.facets << " facets, " << r.layers << " layers, "
+            << r.total << " s, " << std::setprecision(1) << r.peak_rss << " MB" << std::endl;
+    }
+    // the machine may have been busy or slow to clock up at the start
+    calibration = std::min(calibration, calibrate());
+
+    if (output.empty()) {
+        write_json(std::cout, calibration, results);
+    } else {
+        std::ofstream out(output);
+        write_json(out, calibration, results);
+    }
+    if (!baseline.empty() && compare(baseline, calibration, results, time_tolerance, memory_tolerance) > 0)
+        return 1;
+    return 0;
+}
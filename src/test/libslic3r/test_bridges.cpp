@@ -0,0 +1,67 @@
+#include <catch.hpp>
+
+#include "BridgeDetector.hpp"
+#include "ExPolygon.hpp"
+#include "ExPolygonCollection.hpp"
+#include "Geometry.hpp"
+
+using namespace Slic3r;
+
+static ExPolygon rectangle(double x, double y, double width, double height)
+{
+    ExPolygon expolygon;
+    expolygon.contour = Polygon::new_scale({ Pointf(x, y), Pointf(x+width, y), Pointf(x+width, y+height), Pointf(x, y+height) });
+    return expolygon;
+}
+
+SCENARIO("Bridge angle detection") {
+    GIVEN("A 20x10 bridge supported at both short ends") {
+        const ExPolygon bridge = rectangle(20, 20, 20, 10);
+        ExPolygonCollection lower;
+        lower.expolygons.push_back(rectangle(18, 20, 2, 10));
+        lower.expolygons.push_back(rectangle(40, 20, 2, 10));
+        BridgeAngleCache cache;
+        
+        WHEN("the angle is detected") {
+            BridgeDetector bd(bridge, lower, scale_(0.5));
+            bd.cache = &cache;
+            REQUIRE(bd.detect_angle());
+            THEN("the bridge spans the gap") {
+                REQUIRE(Geometry::directions_parallel(bd.angle, 0, Geometry::deg2rad(5.)));
+            }
+            THEN("the same bridge again gets the same angle from the cache") {
+                BridgeDetector again(bridge, lower, scale_(0.5));
+                again.cache = &cache;
+                REQUIRE(again.detect_angle());
+                REQUIRE(again.angle == bd.angle);
+            }
+            THEN("the cache is bounded by its size in bytes") {
+                REQUIRE(cache.bytes() > 0);
+                cache.max_bytes = cache.bytes();
+                BridgeDetector other(rectangle(20, 21, 20, 8), lower, scale_(0.5));
+                other.cache = &cache;
+                REQUIRE(other.detect_angle());
+                REQUIRE(cache.bytes() <= cache.max_bytes);
+            }
+        }
+        WHEN("the candidate angles are evaluated by several threads") {
+            BridgeDetector serial(bridge, lower, scale_(0.5));
+            REQUIRE(serial.detect_angle());
+            BridgeDetector parallel(bridge, lower, scale_(0.5));
+            parallel.threads = 4;
+            REQUIRE(parallel.detect_angle());
+            THEN("the angle is the same") {
+                REQUIRE(parallel.angle == serial.angle);
+            }
+        }
+    }
+    GIVEN("A bridge with nothing below") {
+        const ExPolygon bridge = rectangle(20, 20, 20, 10);
+        ExPolygonCollection lower;
+        lower.expolygons.push_back(rectangle(100, 100, 2, 10));
+        THEN("no angle is detected") {
+            BridgeDetector bd(bridge, lower, scale_(0.5));
+            REQUIRE_FALSE(bd.detect_angle());
+        }
+    }
+}
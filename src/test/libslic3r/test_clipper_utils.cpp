@@ -0,0 +1,173 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "ClipperUtils.hpp"
+#include "ExPolygon.hpp"
+#include "Polygon.hpp"
+#include "Polyline.hpp"
+
+using namespace Slic3r;
+
+// Count the heap allocations made while an AllocationCounter is alive, so that
+// the allocations made by a single ClipperUtils call can be measured. Outside of
+// that scope the replaced operators only forward to malloc() and free().
+static std::atomic<bool> counting(false);
+static std::atomic<size_t> allocations(0);
+
+class AllocationCounter {
+    public:
+    AllocationCounter() { allocations = 0; counting = true; };
+    ~AllocationCounter() { counting = false; };
+    size_t count() const { return allocations; };
+};
+
+void* operator new(std::size_t size)
+{
+    if (counting) ++allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// A 20x20 frame with a 1 unit neck joining two 5x5 squares sticking out of it.
+static Polygons frame_with_neck()
+{
+    Polygon contour = Polygon::new_scale({
+        Pointf(0,0), Pointf(20,0), Pointf(20,8), Pointf(26,8), Pointf(26,9),
+        Pointf(31,9), Pointf(31,14), Pointf(26,14), Pointf(26,9.5), Pointf(20,9.5),
+        Pointf(20,20), Pointf(0,20) });
+    Polygon hole = Polygon::new_scale({ Pointf(5,5), Pointf(5,15), Pointf(15,15), Pointf(15,5) });
+    return { contour, hole };
+}
+
+SCENARIO("Points are passed to Clipper without conversion") {
+    GIVEN("A polygon") {
+        const Polygon polygon = frame_with_neck().front();
+        THEN("the Clipper path view aliases the polygon points") {
+            const ClipperLib::IntPoint* pts = to_clipper_points(polygon.points);
+            for (size_t i = 0; i < polygon.points.size(); ++i) {
+                REQUIRE(pts[i].X == polygon.points[i].x);
+                REQUIRE(pts[i].Y == polygon.points[i].y);
+            }
+        }
+        THEN("a round trip through a Clipper path gives the same polygon") {
+            const Polygon back = ClipperPath_to_Slic3rMultiPoint<Polygon>(Slic3rMultiPoint_to_ClipperPath(polygon));
+            REQUIRE(back.points == polygon.points);
+        }
+    }
+}
+
+TEST_CASE("Allocations per offset2_ex call", "[ClipperUtils][.benchmark]") {
+    const Polygons polygons = frame_with_neck();
+    const float delta1 = -scale_(1), delta2 = scale_(1);
+    const double scale = CLIPPER_OFFSET_SCALE;
+    const int runs = 100;
+
+    // warm up the per-thread engines and scratch buffers
+    ExPolygons result = offset2_ex(polygons, delta1, delta2);
+    REQUIRE(result.size() == 2);
+
+    double per_call;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < runs; ++i)
+            result = offset2_ex(polygons, delta1, delta2);
+        per_call = double(counter.count()) / runs;
+    }
+
+    // the same work done directly on Clipper, with the input converted beforehand
+    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
+    scaleClipperPolygons(input, scale);
+    double clipper_per_call;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < runs; ++i) {
+            ClipperLib::ClipperOffset co(3);
+            ClipperLib::Paths output;
+            co.AddPaths(input, jtMiter, ClipperLib::etClosedPolygon);
+            co.Execute(output, delta1 * scale);
+            co.Clear();
+            co.AddPaths(output, jtMiter, ClipperLib::etClosedPolygon);
+            co.Execute(output, delta2 * scale);
+            scaleClipperPolygons(output, 1/scale);
+            ClipperLib::Clipper clipper;
+            clipper.AddPaths(output, ClipperLib::ptSubject, true);
+            ClipperLib::PolyTree polytree;
+            clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);
+        }
+        clipper_per_call = double(counter.count()) / runs;
+    }
+
+    // the ExPolygons vector, and one points vector and one holes vector per expolygon
+    size_t output_allocations = 1;
+    for (const ExPolygon &expolygon : result)
+        output_allocations += 2 + expolygon.holes.size();
+
+    INFO("offset2_ex: " << per_call << " allocations per call, Clipper alone: " << clipper_per_call);
+    REQUIRE(per_call <= clipper_per_call + output_allocations);
+}
+
+static Polygon square(double x, double y, double size)
+{
+    return Polygon::new_scale({ Pointf(x, y), Pointf(x+size, y), Pointf(x+size, y+size), Pointf(x, y+size) });
+}
+
+static double total_area(const Polygons &polygons)
+{
+    double area = 0;
+    for (const Polygon &polygon : polygons) area += polygon.area();
+    return area;
+}
+
+static double total_length(const Polylines &polylines)
+{
+    double length = 0;
+    for (const Polyline &polyline : polylines) length += polyline.length();
+    return length;
+}
+
+SCENARIO("Boolean operations partitioned by bounding box") {
+    GIVEN("A grid of islands, a few of them touched by clip squares") {
+        Polygons subject, clip;
+        for (int i = 0; i < 10; ++i)
+            for (int j = 0; j < 10; ++j)
+                subject.push_back(square(i*10, j*10, 5));
+        clip.push_back(square(2, 2, 5));
+        clip.push_back(square(43, 41, 10));
+        clip.push_back(square(200, 200, 5));
+        THEN("diff gives the same result as without partitioning") {
+            const Polygons result = diff_partitioned(subject, clip);
+            REQUIRE(std::abs(total_area(result) - total_area(diff(subject, clip))) < 1.);
+            REQUIRE(result.size() == diff(subject, clip).size());
+        }
+        THEN("diff with safety offset gives the same result as without partitioning") {
+            REQUIRE(std::abs(total_area(diff_partitioned(subject, clip, true)) - total_area(diff(subject, clip, true))) < 1.);
+        }
+        THEN("intersection gives the same result as without partitioning") {
+            const Polygons result = intersection_partitioned(subject, clip);
+            REQUIRE(result.size() == 5);
+            REQUIRE(std::abs(total_area(result) - total_area(intersection(subject, clip))) < 1.);
+        }
+        THEN("polyline clipping gives the same result as without partitioning") {
+            REQUIRE(std::abs(total_length(intersection_pl_partitioned(subject, clip)) - total_length(intersection_pl(subject, clip))) < 1.);
+            REQUIRE(std::abs(total_length(diff_pl_partitioned(subject, clip)) - total_length(diff_pl(subject, clip))) < 1.);
+        }
+        THEN("clipping the clusters in parallel gives the same result") {
+            REQUIRE(std::abs(total_area(diff_partitioned(subject, clip, false, 4)) - total_area(diff(subject, clip))) < 1.);
+        }
+    }
+    GIVEN("No clip polygon") {
+        const Polygons subject { square(0, 0, 5), square(10, 0, 5) };
+        THEN("diff returns the subject untouched") {
+            REQUIRE(diff_partitioned(subject, Polygons()).size() == 2);
+        }
+        THEN("intersection is empty") {
+            REQUIRE(intersection_partitioned(subject, Polygons()).empty());
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch.hpp>
+
+#include <memory>
+
+#include "ExtrusionArena.hpp"
+#include "ExtrusionEntity.hpp"
+#include "ExtrusionEntityCollection.hpp"
+
+using namespace Slic3r;
+
+static ExtrusionPath make_path(ExtrusionRole role, const Points &points)
+{
+    ExtrusionPath path(role, 0.05, 0.5, 0.3);
+    path.polyline.points = points;
+    return path;
+}
+
+// A layer region like collection: a nested collection of two loops and a few
+// loose paths scattered around.
+static ExtrusionEntityCollection make_collection()
+{
+    ExtrusionEntityCollection loops;
+    ExtrusionLoop outer(elrContourInternalPerimeter);
+    outer.paths.push_back(make_path(erExternalPerimeter, { Point(0,0), Point(100,0), Point(100,100) }));
+    outer.paths.push_back(make_path(erOverhangPerimeter, { Point(100,100), Point(0,100), Point(0,0) }));
+    ExtrusionLoop inner;
+    inner.paths.push_back(make_path(erPerimeter, { Point(10,10), Point(90,10), Point(90,90), Point(10,90), Point(10,10) }));
+    loops.append(outer);
+    loops.append(inner);
+    loops.no_sort = true;
+
+    ExtrusionEntityCollection collection;
+    collection.append(loops);
+    collection.append(make_path(erSolidInfill, { Point(500,500), Point(400,500) }));
+    collection.append(make_path(erInternalInfill, { Point(200,0), Point(300,0), Point(300,50) }));
+    collection.append(make_path(erInternalInfill, { Point(1000,0), Point(350,0) }));
+    return collection;
+}
+
+SCENARIO("ExtrusionArena") {
+    GIVEN("A nested collection of loops and paths") {
+        const ExtrusionEntityCollection collection = make_collection();
+        ExtrusionArena arena;
+        const size_t root = arena.append(collection);
+
+        THEN("all the points are stored in a single pool") {
+            REQUIRE(arena.points.size() == 18);
+            REQUIRE(arena.paths.size() == 6);
+        }
+        THEN("converting the nodes back gives the original entities") {
+            std::unique_ptr<ExtrusionEntity> copy(arena.entity(root));
+            const ExtrusionEntityCollection* coll = dynamic_cast<const ExtrusionEntityCollection*>(copy.get());
+            REQUIRE(coll != nullptr);
+            REQUIRE(coll->entities.size() == collection.entities.size());
+            const ExtrusionEntityCollection* loops = dynamic_cast<const ExtrusionEntityCollection*>(coll->entities.front());
+            REQUIRE(loops != nullptr);
+            REQUIRE(loops->no_sort);
+            const ExtrusionLoop* outer = dynamic_cast<const ExtrusionLoop*>(loops->entities.front());
+            REQUIRE(outer != nullptr);
+            REQUIRE(outer->role == elrContourInternalPerimeter);
+            REQUIRE(outer->paths.size() == 2);
+            REQUIRE(outer->paths[1].role == erOverhangPerimeter);
+            REQUIRE(outer->paths[1].polyline.points == Points({ Point(100,100), Point(0,100), Point(0,0) }));
+            REQUIRE(outer->paths[1].width == Approx(0.5));
+            REQUIRE(coll->entities.back()->length() == Approx(collection.entities.back()->length()));
+        }
+        THEN("flatten lists the same leaves as ExtrusionEntityCollection::flatten()") {
+            std::vector<size_t> leaves;
+            arena.flatten(root, &leaves);
+            ExtrusionEntitiesConstPtr entities;
+            collection.flatten(&entities);
+            REQUIRE(leaves.size() == 5);
+            REQUIRE(entities.size() == leaves.size());
+            for (size_t i = 0; i < leaves.size(); ++i) {
+                REQUIRE(arena.first_point(leaves[i]) == entities[i]->first_point());
+                REQUIRE(arena.last_point(leaves[i]) == entities[i]->last_point());
+                REQUIRE(arena.length(leaves[i]) == Approx(entities[i]->length()));
+                REQUIRE(arena.is_solid_infill(leaves[i]) == entities[i]->is_solid_infill());
+            }
+        }
+        THEN("chained_path_from gives the same order as ExtrusionEntityCollection") {
+            const Point start(600, 0);
+            ExtrusionEntityCollection chained;
+            collection.chained_path_from(start, &chained);
+
+            std::vector< std::pair<size_t,bool> > order;
+            for (size_t i = 0; i < collection.entities.size(); ++i)
+                order.push_back(std::make_pair(arena.children[arena.nodes[root].first + i], false));
+            arena.chained_path_from(start, &order);
+
+            REQUIRE(order.size() == chained.entities.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                std::unique_ptr<ExtrusionEntity> entity(arena.entity(order[i].first));
+                if (order[i].second) entity->reverse();
+                REQUIRE(entity->first_point() == chained.entities[i]->first_point());
+                REQUIRE(entity->last_point() == chained.entities[i]->last_point());
+            }
+        }
+        THEN("nodes can be loaded into existing entities") {
+            std::vector<size_t> leaves;
+            arena.flatten(root, &leaves);
+            ExtrusionLoop loop;
+            loop.paths.push_back(make_path(erSkirt, { Point(1,1), Point(2,2), Point(3,3), Point(4,4) }));
+            loop.paths.push_back(make_path(erSkirt, { Point(4,4), Point(1,1) }));
+            loop.paths.push_back(make_path(erSkirt, { Point(1,1), Point(1,1) }));
+            arena.load_loop(leaves[0], &loop);
+            REQUIRE(loop.role == elrContourInternalPerimeter);
+            REQUIRE(loop.paths.size() == 2);
+            REQUIRE(loop.paths[0].role == erExternalPerimeter);
+            REQUIRE(loop.paths[0].polyline.points == Points({ Point(0,0), Point(100,0), Point(100,100) }));
+            ExtrusionPath path(erNone);
+            arena.load_path(arena.nodes[leaves[3]].first, &path);
+            REQUIRE(path.role == erInternalInfill);
+            REQUIRE(path.polyline.points.size() == 3);
+            REQUIRE(path.mm3_per_mm == Approx(0.05));
+        }
+        THEN("clear() empties the arena") {
+            arena.clear();
+            REQUIRE(arena.empty());
+            REQUIRE(arena.points.empty());
+        }
+    }
+}
+
+SCENARIO("ExtrusionEntityCollection::flatten") {
+    GIVEN("A nested collection") {
+        const ExtrusionEntityCollection collection = make_collection();
+        THEN("the flattened copy holds the leaves in order") {
+            const ExtrusionEntityCollection flat = collection.flatten();
+            REQUIRE(flat.entities.size() == 5);
+            REQUIRE(flat.entities.front()->first_point() == Point(0,0));
+            REQUIRE(flat.entities.back()->first_point() == Point(1000,0));
+        }
+        THEN("the non-owning flatten points into the collection itself") {
+            ExtrusionEntitiesConstPtr entities;
+            collection.flatten(&entities);
+            REQUIRE(entities.size() == 5);
+            REQUIRE(entities.back() == collection.entities.back());
+        }
+    }
+}
@@ -8,6 +8,7 @@
 #include "Line.hpp"
 #include "Geometry.hpp"
 #include "ClipperUtils.hpp"
+#include <chrono>
 
 using namespace Slic3r;
 
@@ -376,3 +377,52 @@ TEST_CASE("Triangle Simplification does not result in less than 3 points"){
 }
 
     
+
+SCENARIO("Clipping against prepared ClipperIslands") {
+    auto square = [](double x, double y, double size) {
+        return Polygon::new_scale({ Pointf(x, y), Pointf(x+size, y), Pointf(x+size, y+size), Pointf(x, y+size) });
+    };
+    GIVEN("A square subject and two clip islands, one of them far away") {
+        const Polygons subject { square(0, 0, 10) };
+        ExPolygon near_island, far_island;
+        near_island.contour = square(5, 5, 10);
+        far_island.contour  = square(100, 100, 10);
+        const ExPolygons clip { near_island, far_island };
+        const ClipperIslands islands(clip);
+        THEN("diff gives the same area as with plain polygons") {
+            REQUIRE(std::abs(diff(subject, islands, true).front().area() - diff(subject, to_polygons(clip), true).front().area()) < 1.);
+        }
+        THEN("intersection gives the same area as with plain polygons") {
+            REQUIRE(std::abs(intersection(subject, islands).front().area() - intersection(subject, to_polygons(clip)).front().area()) < 1.);
+        }
+        THEN("intersection with only disjoint islands is empty") {
+            REQUIRE(intersection(subject, ClipperIslands({ far_island })).empty());
+        }
+    }
+}
+
+SCENARIO("Medial axis throughput on thin walls", "[benchmark]") {
+    GIVEN("A comb with 50 thin teeth on a thin spine") {
+        Polygons parts { Polygon::new_scale({ Pointf(0,0), Pointf(100,0), Pointf(100,0.4), Pointf(0,0.4) }) };
+        for (int i = 0; i < 50; ++i)
+            parts.push_back(Polygon::new_scale({ Pointf(i*2,0), Pointf(i*2+0.4,0), Pointf(i*2+0.4,5), Pointf(i*2,5) }));
+        const ExPolygons comb = union_ex(parts);
+        REQUIRE(comb.size() == 1);
+        WHEN("the medial axis is computed") {
+            const auto start = std::chrono::steady_clock::now();
+            ThickPolylines polylines;
+            comb.front().medial_axis(comb.front(), scale_(1), scale_(0.1), &polylines);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            INFO("medial axis of the comb: " << polylines.size() << " polylines in " << seconds << " s");
+            THEN("every tooth ends a polyline") {
+                REQUIRE(polylines.size() >= 50);
+            }
+            THEN("the polylines follow the spine and the teeth") {
+                double length = 0;
+                for (const ThickPolyline &polyline : polylines) length += polyline.length();
+                REQUIRE(unscale(length) > 0.9 * 350);
+                REQUIRE(unscale(length) < 1.05 * 350);
+            }
+        }
+    }
+}
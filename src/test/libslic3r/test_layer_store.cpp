@@ -0,0 +1,103 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+#include "test_data.hpp"
+#include "libslic3r.h"
+#include "LayerStore.hpp"
+
+using namespace Slic3r::Test;
+using namespace Slic3r;
+
+// G-code without the lines which legitimately differ between two exports
+// (the timestamp and the value of the option under test).
+static std::string comparable_gcode(shared_Print print)
+{
+    std::stringstream gcode;
+    Slic3r::Test::gcode(gcode, print);
+    std::string line, result;
+    std::getline(gcode, line);
+    while (std::getline(gcode, line))
+        if (line.find("layer_memory_window") == std::string::npos)
+            result += line + "\n";
+    return result;
+}
+
+static size_t count_extrusions(const Layer &layer)
+{
+    size_t count = 0;
+    for (const LayerRegion* layerm : layer.regions)
+        count += layerm->perimeters.items_count() + layerm->fills.items_count();
+    return count;
+}
+
+SCENARIO("Layer store") {
+    GIVEN("An overhanging object with support material") {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("support_material", true);
+        config->set("skirts", 1);
+        Slic3r::Model model;
+        auto reference {Slic3r::Test::init_print({TestMesh::overhang}, model, config)};
+        reference->process();
+
+        config->set("layer_memory_window", 3);
+        Slic3r::Model spilled_model;
+        auto print {Slic3r::Test::init_print({TestMesh::overhang}, spilled_model, config)};
+        print->process();
+        PrintObject &object = *print->objects.front();
+        const PrintObject &reference_object = *reference->objects.front();
+
+        THEN("the finished layers are on disk and not in memory") {
+            REQUIRE(object.support_layers.size() > 0);
+            REQUIRE(object.layer_store.spilled_layers() == object.layers.size() + object.support_layers.size());
+            REQUIRE(object.layer_store.file_size() > 0);
+            REQUIRE_FALSE(object.layer_store.is_resident(object.layers[10]));
+            REQUIRE(count_extrusions(*object.layers[10]) == 0);
+            REQUIRE(object.layers[10]->regions.front()->slices.surfaces.empty());
+        }
+        THEN("the islands stay in memory") {
+            REQUIRE(object.layers[10]->slices.expolygons.size() == reference_object.layers[10]->slices.expolygons.size());
+        }
+        THEN("paging a layer in restores its contents") {
+            object.layer_store.page_in(object.layers[10]);
+            REQUIRE(object.layer_store.is_resident(object.layers[10]));
+            REQUIRE(count_extrusions(*object.layers[10]) == count_extrusions(*reference_object.layers[10]));
+            const LayerRegion &layerm = *object.layers[10]->regions.front();
+            const LayerRegion &reference_layerm = *reference_object.layers[10]->regions.front();
+            REQUIRE(layerm.slices.surfaces.size() == reference_layerm.slices.surfaces.size());
+            REQUIRE(layerm.fill_surfaces.surfaces.size() == reference_layerm.fill_surfaces.surfaces.size());
+            REQUIRE(layerm.perimeters.first_point() == reference_layerm.perimeters.first_point());
+            REQUIRE(layerm.fills.min_mm3_per_mm() == Approx(reference_layerm.fills.min_mm3_per_mm()));
+        }
+        THEN("no more than the window of layers is paged in at a time") {
+            for (size_t i = 5; i < 10; ++i)
+                object.layer_store.page_in(object.layers[i]);
+            REQUIRE_FALSE(object.layer_store.is_resident(object.layers[6]));
+            REQUIRE(count_extrusions(*object.layers[6]) == 0);
+            REQUIRE(object.layer_store.is_resident(object.layers[7]));
+            REQUIRE(object.layer_store.is_resident(object.layers[9]));
+            object.layer_store.release(object.layers[9]);
+            REQUIRE(count_extrusions(*object.layers[9]) == 0);
+        }
+        THEN("invalidating a step brings all the layers back") {
+            object.invalidate_step(posInfill);
+            REQUIRE(object.layer_store.spilled_layers() == 0);
+            REQUIRE(count_extrusions(*object.layers[10]) == count_extrusions(*reference_object.layers[10]));
+        }
+    }
+    GIVEN("A 20mm cube") {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("skirts", 1);
+        config->set("fill_density", 0.2);
+        Slic3r::Model model;
+        auto reference {Slic3r::Test::init_print({TestMesh::cube_20x20x20}, model, config)};
+
+        config->set("layer_memory_window", 2);
+        Slic3r::Model spilled_model;
+        auto print {Slic3r::Test::init_print({TestMesh::cube_20x20x20}, spilled_model, config)};
+
+        THEN("the G-code is the same as without the store") {
+            REQUIRE(comparable_gcode(print) == comparable_gcode(reference));
+        }
+    }
+}
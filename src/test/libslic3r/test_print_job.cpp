@@ -0,0 +1,129 @@
+#include <catch.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include "test_data.hpp"
+#include "libslic3r.h"
+#include "PrintJob.hpp"
+
+using namespace Slic3r::Test;
+using namespace Slic3r;
+
+// G-code without the timestamp line.
+static std::string strip_header(std::istream &gcode)
+{
+    std::string line, result;
+    std::getline(gcode, line);
+    while (std::getline(gcode, line))
+        result += line + "\n";
+    return result;
+}
+
+static std::string reference_gcode(shared_Print print)
+{
+    std::stringstream gcode;
+    Slic3r::Test::gcode(gcode, print);
+    return strip_header(gcode);
+}
+
+static std::string file_gcode(const std::string &path)
+{
+    std::ifstream gcode(path);
+    return strip_header(gcode);
+}
+
+static bool reused(const std::vector<PrintJob::StepTiming> &timings, const std::string &step)
+{
+    for (const PrintJob::StepTiming &timing : timings)
+        if (timing.step == step)
+            return timing.reused;
+    FAIL("step " << step << " not reported");
+    return false;
+}
+
+SCENARIO("PrintJob") {
+    GIVEN("A 20mm cube with 20% infill") {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("skirts", 1);
+        config->set("fill_density", 0.2);
+        Slic3r::Model reference_model;
+        auto reference {Slic3r::Test::init_print({TestMesh::cube_20x20x20}, reference_model, config)};
+        Slic3r::Model model;
+        auto print {Slic3r::Test::init_print({TestMesh::cube_20x20x20}, model, config)};
+
+        const std::string path = (boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("slic3r-test-%%%%-%%%%.gcode")).string();
+        PrintJob job(print.get());
+
+        WHEN("the job runs to the end") {
+            std::vector<std::string> steps;
+            job.step_cb = [&steps](const PrintJob::StepTiming &timing) { steps.push_back(timing.step); };
+            job.start(path);
+            THEN("the G-code is exported and every step is reported") {
+                REQUIRE(job.wait() == PrintJob::pjFinished);
+                REQUIRE(file_gcode(path) == reference_gcode(reference));
+                REQUIRE(steps == std::vector<std::string>({ "slice", "prepare_infill", "infill",
+                    "support_material", "skirt", "brim", "export_gcode" }));
+                REQUIRE(job.timings().size() == steps.size());
+                REQUIRE(job.timings().front().object == print->objects.front());
+                REQUIRE_FALSE(reused(job.timings(), "slice"));
+            }
+        }
+        WHEN("the job is canceled between two steps") {
+            CancellationToken token = print->cancel_token;
+            job.step_cb = [token](const PrintJob::StepTiming &timing) mutable {
+                if (timing.step == "prepare_infill") token.cancel();
+            };
+            job.start(path);
+            THEN("the finished steps are kept") {
+                REQUIRE(job.wait() == PrintJob::pjCanceled);
+                REQUIRE_FALSE(boost::filesystem::exists(path));
+                REQUIRE(print->objects.front()->state.is_done(posPrepareInfill));
+                REQUIRE_FALSE(print->objects.front()->state.is_started(posInfill));
+            }
+            THEN("running it again only does the remaining steps") {
+                job.wait();
+                job.step_cb = nullptr;
+                job.start(path);
+                REQUIRE(job.wait() == PrintJob::pjFinished);
+                REQUIRE(reused(job.timings(), "slice"));
+                REQUIRE(reused(job.timings(), "prepare_infill"));
+                REQUIRE_FALSE(reused(job.timings(), "infill"));
+                REQUIRE(file_gcode(path) == reference_gcode(reference));
+            }
+        }
+        WHEN("the job is canceled in the middle of a step") {
+            CancellationToken token = print->cancel_token;
+            job.status_cb = [token](int percent, const std::string &message) mutable {
+                if (message == "Preparing infill") token.cancel();
+            };
+            job.start(path);
+            THEN("the step is undone and the job can run again") {
+                REQUIRE(job.wait() == PrintJob::pjCanceled);
+                REQUIRE_FALSE(print->objects.front()->state.is_started(posPrepareInfill));
+                job.status_cb = nullptr;
+                job.start(path);
+                REQUIRE(job.wait() == PrintJob::pjFinished);
+                REQUIRE(file_gcode(path) == reference_gcode(reference));
+            }
+        }
+        WHEN("the configuration changes after the job finished") {
+            job.start(path);
+            job.wait();
+            config->set("fill_density", 0.4);
+            REQUIRE(job.apply_config(config->config()));
+            THEN("the job runs again and reuses the steps still valid") {
+                REQUIRE(job.wait() == PrintJob::pjFinished);
+                REQUIRE(reused(job.timings(), "slice"));
+                REQUIRE_FALSE(reused(job.timings(), "infill"));
+
+                reference->apply_config(config->config());
+                REQUIRE(file_gcode(path) == reference_gcode(reference));
+            }
+        }
+        job.wait();
+        boost::filesystem::remove(path);
+    }
+}
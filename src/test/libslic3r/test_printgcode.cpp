@@ -1,9 +1,11 @@
 #include <catch.hpp>
 
+#include <cmath>
 #include <regex>
 #include "test_data.hpp"
 #include "libslic3r.h"
 #include "GCodeReader.hpp"
+#include "GCode/BinaryGCode.hpp"
 
 using namespace Slic3r::Test;
 using namespace Slic3r;
@@ -228,3 +230,109 @@ SCENARIO( "PrintGCode basic functionality") {
         gcode.clear();
     }
 }
+
+SCENARIO( "Binary G-code export") {
+    GIVEN("The text G-code of a commented 20mm cube") {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("gcode_comments", true);
+        std::stringstream gcode;
+        Slic3r::Model model;
+        auto print {Slic3r::Test::init_print({TestMesh::cube_20x20x20}, model, config)};
+        Slic3r::Test::gcode(gcode, print);
+        const std::string exported {gcode.str() + "G1 X1  Y2 ;odd spacing\nG1 X-0.0 Y.5\nM117 no newline"};
+
+        WHEN("it is encoded in small binary blocks") {
+            std::stringstream binary;
+            {
+                BinaryGCodeEncoder encoder(binary, 4096);
+                std::ostream out(&encoder);
+                out << exported;
+                encoder.finish();
+            }
+            THEN("the output is detected as binary G-code") {
+                REQUIRE(BinaryGCode::is_binary(binary));
+                REQUIRE_FALSE(BinaryGCode::is_binary(gcode));
+            }
+            THEN("the output is at least 3 times smaller than the text") {
+                REQUIRE(binary.str().size() * 3 < exported.size());
+            }
+            THEN("decoding reproduces the text byte for byte") {
+                std::stringstream decoded;
+                BinaryGCode::decode(binary, decoded);
+                REQUIRE(decoded.str() == exported);
+            }
+            THEN("GCodeReader sees the same moves as with the text") {
+                GCodeReader text_reader, binary_reader;
+                std::vector<float> text_z, binary_z;
+                text_reader.parse(exported, [&text_z] (GCodeReader& self, const GCodeReader::GCodeLine& line) {
+                    text_z.push_back(line.new_Z());
+                });
+                binary_reader.parse_binary_stream(binary, [&binary_z] (GCodeReader& self, const GCodeReader::GCodeLine& line) {
+                    binary_z.push_back(line.new_Z());
+                });
+                REQUIRE(binary_z == text_z);
+            }
+            THEN("truncated input is rejected") {
+                std::stringstream truncated(binary.str().substr(0, binary.str().size() / 2));
+                std::stringstream decoded;
+                REQUIRE_THROWS(BinaryGCode::decode(truncated, decoded));
+            }
+        }
+    }
+}
+
+// The extrusion moves of every copy of every layer, relative to the first point of the copy.
+static std::vector<std::vector<Pointf>> copy_moves(const std::string &gcode)
+{
+    std::vector<std::vector<Pointf>> copies;
+    std::regex move("^G1 X([-0-9.]+) Y([-0-9.]+) E");
+    std::istringstream lines(gcode);
+    std::string line;
+    bool in_copy = false;
+    while (std::getline(lines, line)) {
+        if (line.find("; printing object") == 0) {
+            copies.emplace_back();
+            in_copy = true;
+        } else if (line.find("; stop printing object") == 0) {
+            in_copy = false;
+        }
+        std::smatch m;
+        if (in_copy && std::regex_search(line, m, move))
+            copies.back().push_back(Pointf(std::stod(m[1]), std::stod(m[2])));
+    }
+    for (auto &copy : copies)
+        for (size_t i = copy.size(); i-- > 0; )
+            copy[i].translate(-copy.front().x, -copy.front().y);
+    return copies;
+}
+
+SCENARIO("G-code of the copies of an object") {
+    GIVEN("A lattice printed 4 times with the seams nearest to the extruder") {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("seam_position", "nearest");
+        config->set("label_printed_objects", true);
+        config->set("fill_density", 0.2);
+        Slic3r::Model model;
+        auto print {Slic3r::Test::init_print({ lattice_mesh(2, 8, 2) }, model, config)};
+        const double pitch = scale_(25);
+        print->objects.front()->set_copies({ Point(0., 0.), Point(pitch, 0.), Point(0., pitch), Point(pitch, pitch) });
+
+        WHEN("the G-code is exported") {
+            std::stringstream gcode;
+            Slic3r::Test::gcode(gcode, print);
+            const auto copies = copy_moves(gcode.str());
+            THEN("every copy of a layer repeats the moves of the first one, translated") {
+                const size_t layers = print->objects.front()->layer_count();
+                REQUIRE(copies.size() == 4 * layers);
+                for (size_t i = 0; i < copies.size(); ++i) {
+                    const auto &first = copies[i - i % 4];
+                    REQUIRE(copies[i].size() == first.size());
+                    double deviation = 0;
+                    for (size_t j = 0; j < first.size(); ++j)
+                        deviation = std::max(deviation, std::hypot(copies[i][j].x - first[j].x, copies[i][j].y - first[j].y));
+                    REQUIRE(deviation < 0.002);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "test_data.hpp"
+#include "libslic3r.h"
+#include "Profiler.hpp"
+
+using namespace Slic3r::Test;
+using namespace Slic3r;
+
+static size_t count_spans(const std::vector<Profiler::Span> &spans, const std::string &name, const std::string &category)
+{
+    return std::count_if(spans.begin(), spans.end(), [&](const Profiler::Span &span) {
+        return span.name == name && span.category == category;
+    });
+}
+
+SCENARIO("Profiler") {
+    GIVEN("A 20mm cube") {
+        auto config {Slic3r::Config::new_from_defaults()};
+        config->set("fill_density", 0.2);
+        config->set("threads", 2);
+        Slic3r::Model model;
+        auto print {Slic3r::Test::init_print({TestMesh::cube_20x20x20}, model, config)};
+
+        WHEN("it is sliced while the profiler is disabled") {
+            Profiler::enable();
+            Profiler::disable();
+            print->process();
+            THEN("nothing is recorded") {
+                REQUIRE(Profiler::spans().empty());
+                REQUIRE(Profiler::counter(Profiler::pcClipperBoolean) == 0);
+            }
+        }
+        WHEN("it is sliced and exported while the profiler is enabled") {
+            Profiler::enable();
+            std::stringstream gcode;
+            Slic3r::Test::gcode(gcode, print);
+            Profiler::disable();
+            const std::vector<Profiler::Span> spans = Profiler::spans();
+
+            THEN("every step is timed once") {
+                for (const char* step : { "slice", "make_perimeters", "detect_surfaces_type",
+                    "prepare_infill", "infill", "generate_support_material", "export_gcode" })
+                    REQUIRE(count_spans(spans, step, "step") == 1);
+            }
+            THEN("the work on every layer is timed") {
+                const size_t layers = print->objects.front()->layer_count();
+                REQUIRE(count_spans(spans, "make_perimeters", "layer") == layers);
+                REQUIRE(count_spans(spans, "make_fills", "layer") == layers);
+                REQUIRE(count_spans(spans, "process_layer", "gcode") == layers);
+                for (const Profiler::Span &span : spans)
+                    if (std::string(span.category) == "layer")
+                        REQUIRE(span.layer >= 0);
+            }
+            THEN("the Clipper operations and the workers are accounted") {
+                REQUIRE(Profiler::counter(Profiler::pcClipperBoolean) > 0);
+                REQUIRE(Profiler::counter(Profiler::pcClipperOffset) > 0);
+                REQUIRE(Profiler::thread_utilisation() > 0);
+                REQUIRE(Profiler::thread_utilisation() <= 1);
+            }
+            THEN("the Chrome trace lists the spans") {
+                std::stringstream trace;
+                Profiler::write_chrome_trace(trace);
+                const std::string json = trace.str();
+                REQUIRE(json.substr(0, 15) == "{\"traceEvents\":");
+                REQUIRE(json.find("\"name\":\"make_perimeters\",\"cat\":\"layer\",\"ph\":\"X\"") != std::string::npos);
+                REQUIRE(json.find("\"clipper_boolean\":") != std::string::npos);
+                REQUIRE(std::count(json.begin(), json.end(), '{') == std::count(json.begin(), json.end(), '}'));
+            }
+        }
+        Profiler::disable();
+    }
+}
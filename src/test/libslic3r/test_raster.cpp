@@ -0,0 +1,105 @@
+#include <catch.hpp>
+
+#include <string>
+#include <boost/filesystem.hpp>
+#include "test_data.hpp"
+#include "libslic3r.h"
+#include "Raster.hpp"
+#include "SLAPrint.hpp"
+#include "Zip/ZipArchive.hpp"
+
+using namespace Slic3r;
+
+static ExPolygon square(double x0, double y0, double x1, double y1)
+{
+    ExPolygon expolygon;
+    expolygon.contour = Polygon::new_scale({ Pointf(x0,y0), Pointf(x1,y0), Pointf(x1,y1), Pointf(x0,y1) });
+    return expolygon;
+}
+
+SCENARIO("Raster") {
+    GIVEN("A 10x10 image of 1mm pixels") {
+        Raster raster(10, 10, Pointf(0, 0), 1., 4);
+        WHEN("a square aligned to the pixels is drawn") {
+            raster.draw(square(2, 2, 6, 6));
+            THEN("the pixels inside are full and the ones outside empty") {
+                REQUIRE(raster.at(2, 4) == 255);
+                REQUIRE(raster.at(5, 7) == 255);
+                REQUIRE(raster.at(1, 5) == 0);
+                REQUIRE(raster.at(6, 5) == 0);
+            }
+            THEN("Y grows upwards") {
+                REQUIRE(raster.at(3, 3) == 0);
+                REQUIRE(raster.at(3, 8) == 0);
+                REQUIRE(raster.at(3, 4) == 255);
+            }
+        }
+        WHEN("a square ending in the middle of pixels is drawn") {
+            raster.draw(square(2.5, 2, 6, 6.5));
+            THEN("the edge pixels are half covered") {
+                REQUIRE(raster.at(2, 5) == 128);
+                REQUIRE(raster.at(4, 3) == 128);
+                REQUIRE(raster.at(3, 5) == 255);
+            }
+        }
+        WHEN("a square with a hole is drawn") {
+            ExPolygon expolygon = square(1, 1, 9, 9);
+            Polygon hole = square(3, 3, 7, 7).contour;
+            hole.reverse();
+            expolygon.holes.push_back(hole);
+            raster.draw(expolygon);
+            THEN("the hole is empty") {
+                REQUIRE(raster.at(1, 5) == 255);
+                REQUIRE(raster.at(5, 5) == 0);
+            }
+        }
+        WHEN("a triangle is drawn") {
+            ExPolygon triangle;
+            triangle.contour = Polygon::new_scale({ Pointf(0,0), Pointf(10,0), Pointf(0,10) });
+            raster.draw(triangle);
+            THEN("the pixels on the diagonal are partially covered") {
+                REQUIRE(raster.at(4, 4) > 0);
+                REQUIRE(raster.at(4, 4) < 255);
+                REQUIRE(raster.at(2, 8) == 255);
+                REQUIRE(raster.at(8, 2) == 0);
+            }
+        }
+        THEN("the image can be encoded as PNG") {
+            raster.draw(square(2, 2, 6, 6));
+            const std::string png = raster.png();
+            REQUIRE(png.substr(0, 4) == "\x89PNG");
+        }
+    }
+}
+
+SCENARIO("SLAPrint raster export") {
+    GIVEN("A 20mm cube sliced with 1mm layers") {
+        Model model = Slic3r::Test::model("cube", Slic3r::Test::mesh(Slic3r::Test::TestMesh::cube_20x20x20));
+        SLAPrint print(&model);
+        print.config.layer_height.value = 1;
+        print.config.first_layer_height.value = 1;
+        print.config.sla_pixel_size.value = 0.5;
+        print.config.threads.value = 2;
+        print.slice();
+
+        const std::string path = (boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("slic3r-test-%%%%-%%%%.zip")).string();
+        print.write_png(path);
+
+        THEN("the archive holds one PNG image per layer") {
+            mz_zip_archive zip;
+            memset(&zip, 0, sizeof(zip));
+            REQUIRE(mz_zip_reader_init_file(&zip, path.c_str(), 0));
+            REQUIRE(mz_zip_reader_get_num_files(&zip) == print.layers.size());
+            REQUIRE(mz_zip_reader_locate_file(&zip, "layer00000.png", nullptr, 0) == 0);
+
+            size_t size = 0;
+            void* data = mz_zip_reader_extract_file_to_heap(&zip, "layer00010.png", &size, 0);
+            REQUIRE(data != nullptr);
+            REQUIRE(std::string(static_cast<const char*>(data), 4) == "\x89PNG");
+            mz_free(data);
+            mz_zip_reader_end(&zip);
+        }
+        boost::filesystem::remove(path);
+    }
+}
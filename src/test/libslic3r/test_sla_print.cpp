@@ -0,0 +1,67 @@
+#include <catch.hpp>
+
+#include "test_data.hpp"
+#include "libslic3r.h"
+#include "ClipperUtils.hpp"
+#include "SLAPrint.hpp"
+
+using namespace Slic3r;
+
+SCENARIO("SLAPrint infill and support") {
+    GIVEN("An overhanging object sliced with 0.5mm layers and 20% infill") {
+        Model model = Slic3r::Test::model("overhang", Slic3r::Test::mesh(Slic3r::Test::TestMesh::overhang));
+        SLAPrint print(&model);
+        print.config.apply(Slic3r::Config::new_from_defaults()->config(), true);
+        print.config.layer_height.value = 0.5;
+        print.config.first_layer_height.value = 0.5;
+        print.config.fill_density.value = 20;
+        print.config.fill_pattern.value = ipRectilinear;
+        print.config.support_material.value = true;
+        print.slice();
+
+        THEN("the infill of the hollow layers lies inside the slices") {
+            size_t hollow = 0;
+            for (const SLAPrint::Layer &layer : print.layers) {
+                if (layer.solid) continue;
+                ++hollow;
+                REQUIRE_FALSE(layer.infill.entities.empty());
+                const ExPolygons grown = offset_ex(layer.slices.expolygons, scale_(0.01));
+                for (const ExtrusionEntity* entity : layer.infill.entities) {
+                    const ExtrusionPath* path = dynamic_cast<const ExtrusionPath*>(entity);
+                    REQUIRE(path != nullptr);
+                    REQUIRE(path->polyline.length() > 0);
+                    for (const Point &p : path->polyline.points) {
+                        bool inside = false;
+                        for (const ExPolygon &expolygon : grown)
+                            inside |= expolygon.contains(p);
+                        REQUIRE(inside);
+                    }
+                }
+            }
+            REQUIRE(hollow > 0);
+        }
+        THEN("the layers filled in the same direction get the same lines") {
+            // the rectilinear pattern alternates between two angles
+            const SLAPrint::Layer* layers[2] = { nullptr, nullptr };
+            for (size_t i = 0; i < print.layers.size() && (layers[0] == nullptr || layers[1] == nullptr); ++i)
+                if (!print.layers[i].solid && !print.layers[i].infill.entities.empty())
+                    for (size_t j = i + 2; j < print.layers.size(); j += 2)
+                        if (!print.layers[j].solid && print.layers[j].slices.expolygons.size() == print.layers[i].slices.expolygons.size()) {
+                            layers[0] = &print.layers[i];
+                            layers[1] = &print.layers[j];
+                            break;
+                        }
+            REQUIRE(layers[0] != nullptr);
+            REQUIRE(layers[0]->infill.entities.size() == layers[1]->infill.entities.size());
+            REQUIRE(layers[0]->infill.first_point() == layers[1]->infill.first_point());
+        }
+        THEN("support pillars hang below the overhang") {
+            REQUIRE_FALSE(print.sm_pillars.empty());
+            for (const SLAPrint::SupportPillar &pillar : print.sm_pillars) {
+                REQUIRE(pillar.top_layer >= pillar.bottom_layer);
+                REQUIRE_FALSE(print.layers[pillar.top_layer].slices.contains(Point(pillar)));
+                REQUIRE(print.layers[pillar.top_layer + 1].slices.contains(Point(pillar)));
+            }
+        }
+    }
+}
@@ -27,3 +27,43 @@ SCENARIO("init_print functionality") {
         }
     }
 }
+
+SCENARIO("Stress meshes") {
+    GIVEN("The parametric meshes of the benchmarks") {
+        THEN("the sphere stands on the bed and is as detailed as asked") {
+            const Slic3r::TriangleMesh sphere = sphere_mesh(10, PI / 60);
+            REQUIRE(sphere.bounding_box().min.z == Approx(0));
+            REQUIRE(sphere.bounding_box().max.z == Approx(20));
+            REQUIRE(sphere.facets_count() > 10000);
+        }
+        THEN("the lattice beams span all the cells") {
+            const Slic3r::TriangleMesh lattice = lattice_mesh(3, 10, 2);
+            REQUIRE(lattice.facets_count() == 16 * 3 * 12);
+            REQUIRE(lattice.bounding_box().size().x == Approx(32));
+            REQUIRE(lattice.bounding_box().size().z == Approx(32));
+        }
+        THEN("every pin of the plate is a separate island") {
+            const Slic3r::TriangleMesh plate = island_plate_mesh(4, 5, 5, 1, 3);
+            REQUIRE(plate.bounding_box().min.z == Approx(0));
+            Slic3r::TriangleMeshPtrs pins = plate.split();
+            REQUIRE(pins.size() == 20);
+            for (Slic3r::TriangleMesh* pin : pins) delete pin;
+        }
+        THEN("the tower is as tall as asked") {
+            const Slic3r::TriangleMesh tower = tower_mesh(3, 150);
+            REQUIRE(tower.bounding_box().size().z == Approx(150));
+            REQUIRE(tower.stats().number_of_parts == 1);
+        }
+        WHEN("the meshes are sliced") {
+            Slic3r::Model model;
+            auto print {init_print({ lattice_mesh(2, 8, 2), island_plate_mesh(3, 3, 6, 2, 2) }, model)};
+            print->process();
+            THEN("the lattice gets a layer for its whole height") {
+                REQUIRE(print->objects.front()->layers.back()->print_z == Approx(18).epsilon(0.02));
+            }
+            THEN("the plate gets an island for every pin") {
+                REQUIRE(print->objects.back()->layers.front()->slices.expolygons.size() == 9);
+            }
+        }
+    }
+}
@@ -325,6 +325,59 @@ SCENARIO( "TriangleMesh: split functionality.") {
     }
 }
 
+SCENARIO( "TriangleMesh: split of a plate with many parts.") {
+    GIVEN( "A 20x20 grid of disjoint 2mm cubes merged into a single TriangleMesh") {
+        TriangleMesh plate;
+        for (int i = 0; i < 20; ++i) {
+            for (int j = 0; j < 20; ++j) {
+                TriangleMesh cube = TriangleMesh::make_cube(2, 2, 2);
+                cube.translate(i * 3, j * 3, 0);
+                plate.merge(cube);
+            }
+        }
+        plate.repair();
+        WHEN( "The mesh is split") {
+            TriangleMeshPtrs meshes = plate.split();
+            THEN( "Every cube is a separate mesh with all of its facets.") {
+                REQUIRE(meshes.size() == 400);
+                for (TriangleMesh* mesh : meshes)
+                    REQUIRE(mesh->facets_count() == 12);
+            }
+            THEN( "Parts are ordered by their first facet in the source mesh.") {
+                REQUIRE(meshes.front()->bb3() == BoundingBoxf3(Pointf3(0,0,0), Pointf3(2,2,2)));
+                REQUIRE(meshes.back()->bb3() == BoundingBoxf3(Pointf3(57,57,0), Pointf3(59,59,2)));
+            }
+            for (TriangleMesh* mesh : meshes) delete mesh;
+        }
+    }
+}
+
+SCENARIO( "TriangleMesh: horizontal projection.") {
+    GIVEN( "A square frame made of four boxes, with a bar floating over its hole") {
+        TriangleMesh frame;
+        const double boxes[5][4] = { {0,0,30,5}, {0,25,30,5}, {0,0,5,30}, {25,0,5,30}, {10,-5,5,40} };
+        for (size_t i = 0; i < 5; ++i) {
+            TriangleMesh box = TriangleMesh::make_cube(boxes[i][2], boxes[i][3], 5);
+            box.translate(boxes[i][0], boxes[i][1], (i == 4) ? 10 : 0);
+            frame.merge(box);
+        }
+        frame.repair();
+        const ExPolygons by_facets = frame.horizontal_projection();
+        WHEN( "The projection is built from the silhouette edges") {
+            frame.require_shared_vertices();
+            const ExPolygons by_silhouette = frame.horizontal_projection();
+            THEN( "It has the same shape as the union of the facets.") {
+                REQUIRE(by_facets.size() == 1);
+                REQUIRE(by_silhouette.size() == 1);
+                REQUIRE(by_facets.front().holes.size() == 2);
+                REQUIRE(by_silhouette.front().holes.size() == 2);
+                REQUIRE(by_silhouette.front().area() == Approx(by_facets.front().area()).epsilon(0.001));
+                REQUIRE(unscale(unscale(by_silhouette.front().area())) == Approx(30*30 - 5*20 - 10*20 + 2*5*5).epsilon(0.01));
+            }
+        }
+    }
+}
+
 SCENARIO( "TriangleMesh: Mesh merge functions") {
     GIVEN( "Two 20mm cubes, each with one corner on the origin") {
         const Pointf3s vertices { Pointf3(20,20,0), Pointf3(20,0,0), Pointf3(0,0,0), Pointf3(0,20,0), Pointf3(20,20,20), Pointf3(0,20,20), Pointf3(0,0,20), Pointf3(20,0,20) };
@@ -376,6 +429,45 @@ SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
         }
     }
 }
+SCENARIO( "TriangleMeshSlicer: Cut with several planes.") {
+    GIVEN( "A 20mm cube with one corner on the origin") {
+        TriangleMesh cube = TriangleMesh::make_cube(20, 20, 20);
+        cube.repair();
+        WHEN( "Object is cut at 5, 10 and 15mm in a single pass") {
+            TriangleMeshPtrs parts;
+            TriangleMeshSlicer<Z>(&cube).cut(std::vector<float> { 5, 10, 15 }, &parts);
+            THEN( "Four slabs are returned, bottom up.") {
+                REQUIRE(parts.size() == 4);
+                for (size_t i = 0; i < parts.size(); ++i) {
+                    parts[i]->repair();
+                    REQUIRE(parts[i]->bb3().min.z == Approx(5 * i));
+                    REQUIRE(parts[i]->bb3().max.z == Approx(5 * (i + 1)));
+                    REQUIRE(parts[i]->volume() == Approx(2000));
+                }
+            }
+            THEN( "The outer slabs have as many facets as the halves of a single cut.") {
+                TriangleMesh upper, lower;
+                cube.cut(Z, 5, &upper, &lower);
+                REQUIRE(parts.front()->facets_count() == lower.facets_count());
+            }
+            for (TriangleMesh* part : parts) delete part;
+        }
+        WHEN( "Object is cut by a 5x10mm grid") {
+            TriangleMeshPtrs tiles = cube.cut_by_grid(Pointf(5, 10));
+            THEN( "Tiles are returned column by column, each one filling its grid cell.") {
+                REQUIRE(tiles.size() == 8);
+                for (size_t i = 0; i < tiles.size(); ++i) {
+                    const BoundingBoxf3 bb = tiles[i]->bb3();
+                    REQUIRE(bb.min.x == Approx(5 * (i / 2)));
+                    REQUIRE(bb.min.y == Approx(10 * (i % 2)));
+                    REQUIRE(tiles[i]->volume() == Approx(1000));
+                }
+            }
+            for (TriangleMesh* tile : tiles) delete tile;
+        }
+    }
+}
+
 #ifdef TEST_PERFORMANCE
 TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
     TriangleMesh mesh;
@@ -201,6 +201,54 @@ TriangleMesh mesh(TestMesh m) {
 }
 
 
+TriangleMesh sphere_mesh(double radius, double angle_step)
+{
+    TriangleMesh mesh = Slic3r::TriangleMesh::make_sphere(radius, angle_step);
+    mesh.translate(0, 0, radius);
+    return mesh;
+}
+
+TriangleMesh lattice_mesh(size_t cells, double cell_size, double beam_width)
+{
+    const double length = cells * cell_size + beam_width;
+    TriangleMesh mesh;
+    for (size_t i = 0; i <= cells; ++i) {
+        for (size_t j = 0; j <= cells; ++j) {
+            // one beam along each axis through the nodes (i, j)
+            TriangleMesh x_beam = TriangleMesh::make_cube(length, beam_width, beam_width);
+            x_beam.translate(0, i * cell_size, j * cell_size);
+            TriangleMesh y_beam = TriangleMesh::make_cube(beam_width, length, beam_width);
+            y_beam.translate(i * cell_size, 0, j * cell_size);
+            TriangleMesh z_beam = TriangleMesh::make_cube(beam_width, beam_width, length);
+            z_beam.translate(i * cell_size, j * cell_size, 0);
+            mesh.merge(x_beam);
+            mesh.merge(y_beam);
+            mesh.merge(z_beam);
+        }
+    }
+    mesh.repair();
+    return mesh;
+}
+
+TriangleMesh island_plate_mesh(size_t rows, size_t columns, double pitch, double pin_radius, double height)
+{
+    TriangleMesh mesh;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < columns; ++j) {
+            TriangleMesh pin = TriangleMesh::make_cylinder(pin_radius, height, PI / 12);
+            pin.translate(j * pitch, i * pitch, 0);
+            mesh.merge(pin);
+        }
+    }
+    mesh.repair();
+    return mesh;
+}
+
+TriangleMesh tower_mesh(double radius, double height)
+{
+    return TriangleMesh::make_cylinder(radius, height, PI / 32);
+}
+
 shared_Print init_print(std::initializer_list<TestMesh> meshes, Slic3r::Model& model, config_ptr _config, bool comments) {
     auto config {Slic3r::Config::new_from_defaults()};
     config->apply(_config);
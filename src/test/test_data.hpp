@@ -53,6 +53,18 @@ TriangleMesh mesh(TestMesh m);
 TriangleMesh mesh(TestMesh m, Pointf3 translate, Pointf3 scale = Pointf3(1.0, 1.0, 1.0));
 TriangleMesh mesh(TestMesh m, Pointf3 translate, double scale = 1.0);
 
+/// Parametric stress meshes used by the benchmarks (src/test/benchmark).
+/// All of them stand on Z = 0.
+
+/// A sphere made of about 4 * PI / angle_step^2 facets.
+TriangleMesh sphere_mesh(double radius, double angle_step);
+/// A cubic lattice of cells^3 cells, the beams along the edges of the cells overlapping at the nodes.
+TriangleMesh lattice_mesh(size_t cells, double cell_size, double beam_width);
+/// A grid of rows x columns separate pins, so that every layer has rows x columns islands.
+TriangleMesh island_plate_mesh(size_t rows, size_t columns, double pitch, double pin_radius, double height);
+/// A thin cylinder, for many small layers.
+TriangleMesh tower_mesh(double radius, double height);
+
 /// Templated function to see if two values are equivalent (+/- epsilon)
 template <typename T>
 bool _equiv(const T& a, const T& b) { return abs(a - b) < Slic3r::Geometry::epsilon; }
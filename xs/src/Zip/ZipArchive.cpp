@@ -34,6 +34,17 @@ ZipArchive::add_entry (std::string entry_path, std::string file_path)
     return stats;
 }
 
+mz_bool
+ZipArchive::add_entry_from_memory (std::string entry_path, const void* data, size_t size, int level)
+{
+    stats = 0;
+    // Check if it's in the write mode.
+    if(mode != 'W')
+        return stats;
+    stats = mz_zip_writer_add_mem(&archive, entry_path.c_str(), data, size, level);
+    return stats;
+}
+
 mz_bool
 ZipArchive::extract_entry (std::string entry_path, std::string file_path)
 {
@@ -30,6 +30,14 @@ public:
     /// \return mz_bool 0: failure 1: success.
     mz_bool add_entry (std::string entry_path, std::string file_path);
 
+    /// Add a file held in memory to the current zip archive.
+    /// \param entry_path string the path of the entry in the zip archive.
+    /// \param data pointer to the file contents.
+    /// \param size size of the file contents in bytes.
+    /// \param level int the compression level, 0 stores the data as is (best for already compressed data).
+    /// \return mz_bool 0: failure 1: success.
+    mz_bool add_entry_from_memory (std::string entry_path, const void* data, size_t size, int level = ZIP_DEFLATE_COMPRESSION);
+
     /// Extract a zip entry to a file on the disk.
     /// \param entry_path string the path of the entry in the zip archive.
     /// \param file_path string the path of the file in the disk.
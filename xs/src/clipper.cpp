@@ -1043,6 +1043,12 @@ TEdge* ClipperBase::ProcessBound(TEdge* E, bool NextIsForward)
 //------------------------------------------------------------------------------
 
 bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
+{
+  return AddPath(pg.data(), pg.size(), PolyTyp, Closed);
+}
+//------------------------------------------------------------------------------
+
+bool ClipperBase::AddPath(const IntPoint *pg, size_t cnt, PolyType PolyTyp, bool Closed)
 {
 #ifdef use_lines
   if (!Closed && PolyTyp == ptClip)
@@ -1052,7 +1058,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     throw clipperException("AddPath: Open paths have been disabled.");
 #endif
 
-  int highI = (int)pg.size() -1;
+  int highI = (int)cnt -1;
   if (Closed) while (highI > 0 && (pg[highI] == pg[0])) --highI;
   while (highI > 0 && (pg[highI] == pg[highI -1])) --highI;
   if ((Closed && highI < 2) || (!Closed && highI < 1)) return false;
@@ -3808,7 +3814,13 @@ void ClipperOffset::Clear()
 
 void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType)
 {
-  int highI = (int)path.size() - 1;
+  AddPath(path.data(), path.size(), joinType, endType);
+}
+//------------------------------------------------------------------------------
+
+void ClipperOffset::AddPath(const IntPoint *path, size_t cnt, JoinType joinType, EndType endType)
+{
+  int highI = (int)cnt - 1;
   if (highI < 0) return;
   PolyNode* newNode = new PolyNode();
   newNode->m_jointype = joinType;
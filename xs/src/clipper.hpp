@@ -223,6 +223,8 @@ public:
   ClipperBase();
   virtual ~ClipperBase();
   virtual bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
+  //Slic3r: add a path stored in a caller owned array without copying it into a Path first.
+  bool AddPath(const IntPoint *pg, size_t cnt, PolyType PolyTyp, bool Closed);
   bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
   virtual void Clear();
   IntRect GetBounds();
@@ -363,6 +365,8 @@ public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25);
   ~ClipperOffset();
   void AddPath(const Path& path, JoinType joinType, EndType endType);
+  //Slic3r: add a path stored in a caller owned array without copying it into a Path first.
+  void AddPath(const IntPoint *path, size_t cnt, JoinType joinType, EndType endType);
   void AddPaths(const Paths& paths, JoinType joinType, EndType endType);
   void Execute(Paths& solution, double delta);
   void Execute(PolyTree& solution, double delta);
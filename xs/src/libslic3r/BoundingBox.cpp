@@ -268,4 +268,14 @@ BoundingBoxBase<PointClass>::contains(const PointClass &point) const
 template bool BoundingBoxBase<Point>::contains(const Point &point) const;
 template bool BoundingBoxBase<Pointf>::contains(const Pointf &point) const;
 
+// Touching boxes are considered overlapping.
+template <class PointClass> bool
+BoundingBoxBase<PointClass>::overlap(const BoundingBoxBase<PointClass> &other) const
+{
+    return this->min.x <= other.max.x && other.min.x <= this->max.x
+        && this->min.y <= other.max.y && other.min.y <= this->max.y;
+}
+template bool BoundingBoxBase<Point>::overlap(const BoundingBoxBase<Point> &other) const;
+template bool BoundingBoxBase<Pointf>::overlap(const BoundingBoxBase<Pointf> &other) const;
+
 }
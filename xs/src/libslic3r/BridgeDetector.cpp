@@ -2,13 +2,55 @@
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
 #include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+#include <boost/thread.hpp>
 
 namespace Slic3r {
 
+size_t
+BridgeAngleCache::KeyHash::operator()(const std::vector<coord_t> &key) const
+{
+    return boost::hash_range(key.begin(), key.end());
+}
+
+bool
+BridgeAngleCache::find(const std::vector<coord_t> &key, double* angle) const
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    const auto it = this->_angles.find(key);
+    if (it == this->_angles.end()) return false;
+    *angle = it->second;
+    return true;
+}
+
+void
+BridgeAngleCache::insert(const std::vector<coord_t> &key, double angle)
+{
+    const size_t bytes = key.size() * sizeof(coord_t) + sizeof(double);
+    if (bytes > this->max_bytes) return;
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    if (this->_bytes + bytes > this->max_bytes) {
+        this->_angles.clear();
+        this->_bytes = 0;
+    }
+    if (this->_angles.insert(std::make_pair(key, angle)).second)
+        this->_bytes += bytes;
+}
+
+void
+BridgeAngleCache::clear()
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    this->_angles.clear();
+    this->_bytes = 0;
+}
+
 BridgeDetector::BridgeDetector(const ExPolygon &_expolygon, const ExPolygonCollection &_lower_slices,
     coord_t _extrusion_width)
     : expolygon(_expolygon), extrusion_width(_extrusion_width),
-        resolution(PI/36.0), angle(-1)
+        resolution(PI/36.0), angle(-1), threads(1), cache(NULL)
 {
     /*  outset our bridge by an arbitrary amout; we'll use this outer margin
         for detecting anchors */
@@ -59,6 +101,18 @@ BridgeDetector::detect_angle()
     // and there are no anchors available at the layer below.
     if (this->_edges.empty() || this->_anchors.empty()) return false;
     
+    // the same bridge over the same anchors was already solved
+    std::vector<coord_t> fingerprint;
+    if (this->cache != NULL) {
+        fingerprint = this->_fingerprint();
+        double angle;
+        if (this->cache->find(fingerprint, &angle)) {
+            if (angle == -1) return false;
+            this->angle = angle;
+            return true;
+        }
+    }
+    
     /*  Outset the bridge expolygon by half the amount we used for detecting anchors;
         we'll use this one to clip our test lines and be sure that their endpoints
         are inside the anchors and not on their contours leading to false negatives. */
@@ -106,46 +160,21 @@ BridgeDetector::detect_angle()
             candidates.push_back(BridgeDirection(angle));
     }
     
-    const coord_t line_increment = this->extrusion_width;
+    if (this->threads > 1 && candidates.size() > 1) {
+        std::queue<size_t> queue;
+        for (size_t i = 0; i < candidates.size(); ++i) queue.push(i);
+        parallelize<size_t>(
+            queue,
+            [this, &candidates, &clip_area](size_t i) { this->_evaluate(&candidates[i], clip_area); },
+            this->threads
+        );
+    } else {
+        for (BridgeDirection &candidate : candidates)
+            this->_evaluate(&candidate, clip_area);
+    }
+    
     bool have_coverage = false;
-    for (BridgeDirection &candidate : candidates) {
-        Polygons my_clip_area = clip_area;
-        ExPolygons my_anchors = this->_anchors;
-        
-        // rotate everything - the center point doesn't matter
-        for (Polygon &p : my_clip_area)
-            p.rotate(-candidate.angle, Point(0,0));
-        for (ExPolygon &e : my_anchors)
-            e.rotate(-candidate.angle, Point(0,0));
-    
-        // generate lines in this direction
-        BoundingBox bb;
-        for (const ExPolygon &e : my_anchors)
-            bb.merge(e.bounding_box());
-        
-        Lines lines;
-        for (coord_t y = bb.min.y; y <= bb.max.y; y += line_increment)
-            lines.push_back(Line(Point(bb.min.x, y), Point(bb.max.x, y)));
-        
-        const Lines clipped_lines = intersection_ln(lines, my_clip_area);
-        
-        for (const Line &line : clipped_lines) {
-            // skip any line not having both endpoints within anchors
-            if (!Slic3r::Geometry::contains(my_anchors, line.a)
-                || !Slic3r::Geometry::contains(my_anchors, line.b))
-                continue;
-            
-            candidate.max_length = std::max(candidate.max_length, line.length());
-            // Calculate coverage as actual covered area, because length of centerlines
-            // is not accurate enough when such lines are slightly skewed and not parallel
-            // to the sides; calculating area will compute them as triangles.
-            // TODO: use a faster algorithm for computing covered area by using a sweep line
-            // instead of intersecting many lines.
-            candidate.coverage += Slic3r::Geometry::area(intersection(
-                my_clip_area,
-                offset((Polyline)line, +this->extrusion_width/2)
-            ));
-        }
+    for (const BridgeDirection &candidate : candidates) {
         if (candidate.coverage > 0) have_coverage = true;
         
         #if 0
@@ -157,7 +186,10 @@ BridgeDetector::detect_angle()
     }
     
     // if no direction produced coverage, then there's no bridge direction
-    if (!have_coverage) return false;
+    if (!have_coverage) {
+        if (this->cache != NULL) this->cache->insert(fingerprint, -1);
+        return false;
+    }
     
     // sort directions by coverage - most coverage first
     std::sort(candidates.begin(), candidates.end());
@@ -172,6 +204,7 @@ BridgeDetector::detect_angle()
     this->angle = candidates[i_best].angle;
     
     if (this->angle >= PI) this->angle -= PI;
+    if (this->cache != NULL) this->cache->insert(fingerprint, this->angle);
     
     #ifdef SLIC3R_DEBUG
     printf("  Optimal infill angle is %d degrees\n", (int)Slic3r::Geometry::rad2deg(this->angle));
@@ -180,6 +213,75 @@ BridgeDetector::detect_angle()
     return true;
 }
 
+void
+BridgeDetector::_evaluate(BridgeDirection* candidate, const Polygons &clip_area) const
+{
+    Polygons my_clip_area = clip_area;
+    ExPolygons my_anchors = this->_anchors;
+    
+    // rotate everything - the center point doesn't matter
+    for (Polygon &p : my_clip_area)
+        p.rotate(-candidate->angle, Point(0,0));
+    for (ExPolygon &e : my_anchors)
+        e.rotate(-candidate->angle, Point(0,0));
+    
+    // generate lines in this direction
+    BoundingBox bb;
+    for (const ExPolygon &e : my_anchors)
+        bb.merge(e.bounding_box());
+    
+    const coord_t line_increment = this->extrusion_width;
+    Lines lines;
+    for (coord_t y = bb.min.y; y <= bb.max.y; y += line_increment)
+        lines.push_back(Line(Point(bb.min.x, y), Point(bb.max.x, y)));
+    
+    const Lines clipped_lines = intersection_ln(lines, my_clip_area);
+    
+    for (const Line &line : clipped_lines) {
+        // skip any line not having both endpoints within anchors
+        if (!Slic3r::Geometry::contains(my_anchors, line.a)
+            || !Slic3r::Geometry::contains(my_anchors, line.b))
+            continue;
+        
+        candidate->max_length = std::max(candidate->max_length, line.length());
+        // Calculate coverage as actual covered area, because length of centerlines
+        // is not accurate enough when such lines are slightly skewed and not parallel
+        // to the sides; calculating area will compute them as triangles.
+        // TODO: use a faster algorithm for computing covered area by using a sweep line
+        // instead of intersecting many lines.
+        candidate->coverage += Slic3r::Geometry::area(intersection(
+            my_clip_area,
+            offset((Polyline)line, +this->extrusion_width/2)
+        ));
+    }
+}
+
+/// The detected angle only depends on the bridge, the anchors and the supporting edges
+/// (both derived from the lower slices), the extrusion width and the resolution.
+/// Coordinates are kept absolute: rotating translated copies of a bridge rounds differently,
+/// and reusing their angle would make the result depend on the layer processing order.
+std::vector<coord_t>
+BridgeDetector::_fingerprint() const
+{
+    std::vector<coord_t> key;
+    auto append = [&key](const Points &points) {
+        key.push_back(points.size());
+        for (const Point &p : points) {
+            key.push_back(p.x);
+            key.push_back(p.y);
+        }
+    };
+    key.push_back(this->extrusion_width);
+    key.push_back(coord_t(this->resolution * 1e9));
+    for (const Polygon &p : (Polygons)this->expolygon) append(p.points);
+    key.push_back(this->_anchors.size());
+    for (const ExPolygon &e : this->_anchors)
+        for (const Polygon &p : (Polygons)e) append(p.points);
+    key.push_back(this->_edges.size());
+    for (const Polyline &e : this->_edges) append(e.points);
+    return key;
+}
+
 Polygons
 BridgeDetector::coverage() const
 {
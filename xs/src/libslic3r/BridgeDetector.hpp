@@ -5,9 +5,37 @@
 #include "ExPolygon.hpp"
 #include "ExPolygonCollection.hpp"
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/thread.hpp>
 
 namespace Slic3r {
 
+/// Angles found by BridgeDetector::detect_angle(), -1 when no direction had any coverage.
+/// Prismatic parts get the very same bridges layer after layer, so a PrintObject keeps
+/// one of these for its detectors and releases it with its layers.
+/// Entries are keyed by the whole input of the detection; the cache is dropped as a whole
+/// when the keys it holds exceed max_bytes.
+class BridgeAngleCache {
+public:
+    size_t max_bytes;
+
+    BridgeAngleCache(size_t _max_bytes = 4 << 20) : max_bytes(_max_bytes), _bytes(0) {};
+    bool find(const std::vector<coord_t> &key, double* angle) const;
+    void insert(const std::vector<coord_t> &key, double angle);
+    void clear();
+    /// Memory taken by the keys held, in bytes.
+    size_t bytes() const { return this->_bytes; };
+
+private:
+    struct KeyHash {
+        size_t operator()(const std::vector<coord_t> &key) const;
+    };
+    std::unordered_map<std::vector<coord_t>,double,KeyHash> _angles;
+    size_t _bytes;
+    mutable boost::mutex _mutex;
+};
+
 class BridgeDetector {
 public:
     /// The non-grown hole.
@@ -20,6 +48,11 @@ public:
     double resolution;
     /// The final optimal angle.
     double angle;
+    /// Number of threads evaluating the candidate angles. Detectors are usually
+    /// run by the per-layer worker threads already, hence a single one by default.
+    int threads;
+    /// Memo of the detected angles, none if NULL.
+    BridgeAngleCache* cache;
     
     BridgeDetector(const ExPolygon &_expolygon, const ExPolygonCollection &_lower_slices, coord_t _extrusion_width);
     bool detect_angle();
@@ -48,6 +81,11 @@ private:
         double coverage;
         double max_length;
     };
+    
+    /// Compute the coverage and the longest line of a candidate direction.
+    void _evaluate(BridgeDirection* candidate, const Polygons &clip_area) const;
+    /// Key of the angle cache, made of the whole input of the angle detection.
+    std::vector<coord_t> _fingerprint() const;
 };
 
 }
@@ -1,8 +1,70 @@
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
+#include <algorithm>
+#include <iterator>
+#include <queue>
 
 namespace Slic3r {
 
+// Constructing and tearing down the Clipper engines for every call shows up in the profiles
+// of the per-layer loops, so each thread keeps one engine of each kind and resets it before use.
+// None of the functions below runs two operations on the same engine at once.
+static ClipperLib::Clipper&
+_clipper_engine()
+{
+    Profiler::count(Profiler::pcClipperBoolean);
+    static thread_local ClipperLib::Clipper clipper;
+    clipper.Clear();
+    clipper.PreserveCollinear(false);
+    clipper.StrictlySimple(false);
+    clipper.ReverseSolution(false);
+    return clipper;
+}
+
+static ClipperLib::ClipperOffset&
+_offset_engine(const ClipperLib::JoinType joinType, const double miterLimit)
+{
+    Profiler::count(Profiler::pcClipperOffset);
+    static thread_local ClipperLib::ClipperOffset co;
+    co.Clear();
+    co.MiterLimit   = 2.0;
+    co.ArcTolerance = 0.25;
+    if (joinType == jtRound) {
+        co.ArcTolerance = miterLimit;
+    } else {
+        co.MiterLimit = miterLimit;
+    }
+    return co;
+}
+
+// Feed Slic3r paths to Clipper in place, without an intermediate ClipperLib::Paths copy.
+template <class T>
+static void
+_add_paths(ClipperLib::Clipper &clipper, const T &multipoints, const ClipperLib::PolyType polyType, const bool closed)
+{
+    for (const auto &multipoint : multipoints)
+        clipper.AddPath(to_clipper_points(multipoint.points), multipoint.points.size(), polyType, closed);
+}
+
+// ClipperOffset copies every contour it is given, so the scaled input only needs
+// a scratch path reused for all the contours instead of a scaled copy of the whole set.
+template <class T>
+static void
+_add_scaled_paths(ClipperLib::ClipperOffset &co, const T &multipoints, const double scale,
+    const ClipperLib::JoinType joinType, const ClipperLib::EndType endType)
+{
+    static thread_local ClipperLib::Path scaled;
+    for (const auto &multipoint : multipoints) {
+        const Points &points = multipoint.points;
+        scaled.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            scaled[i].X = points[i].x * scale;
+            scaled[i].Y = points[i].y * scale;
+        }
+        co.AddPath(scaled, joinType, endType);
+    }
+}
+
 //-----------------------------------------------------------
 // legacy code from Clipper documentation
 void AddOuterPolyNodeToExPolygons(ClipperLib::PolyNode& polynode, ExPolygons* expolygons)
@@ -24,6 +86,7 @@ ExPolygons
 PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 {
     ExPolygons retval;
+    retval.reserve(polytree.ChildCount());
     for (int i = 0; i < polytree.ChildCount(); ++i)
         AddOuterPolyNodeToExPolygons(*polytree.Childs[i], &retval);
     return retval;
@@ -35,8 +98,7 @@ T
 ClipperPath_to_Slic3rMultiPoint(const ClipperLib::Path &input)
 {
     T retval;
-    for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
-        retval.points.push_back(Point( (*pit).X, (*pit).Y ));
+    retval.points.assign(from_clipper_points(input), from_clipper_points(input) + input.size());
     return retval;
 }
 template Polygon ClipperPath_to_Slic3rMultiPoint<Polygon>(const ClipperLib::Path &input);
@@ -46,6 +108,7 @@ T
 ClipperPaths_to_Slic3rMultiPoints(const ClipperLib::Paths &input)
 {
     T retval;
+    retval.reserve(input.size());
     for (ClipperLib::Paths::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.push_back(ClipperPath_to_Slic3rMultiPoint<typename T::value_type>(*it));
     return retval;
@@ -55,8 +118,7 @@ ExPolygons
 ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 {
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Clipper &clipper = _clipper_engine();
     
     // perform union
     clipper.AddPaths(input, ClipperLib::ptSubject, true);
@@ -70,10 +132,8 @@ ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 ClipperLib::Path
 Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
 {
-    ClipperLib::Path retval;
-    for (Points::const_iterator pit = input.points.begin(); pit != input.points.end(); ++pit)
-        retval.push_back(ClipperLib::IntPoint( (*pit).x, (*pit).y ));
-    return retval;
+    const ClipperLib::IntPoint* points = to_clipper_points(input.points);
+    return ClipperLib::Path(points, points + input.points.size());
 }
 
 template <class T>
@@ -81,6 +141,7 @@ ClipperLib::Paths
 Slic3rMultiPoints_to_ClipperPaths(const T &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (typename T::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.push_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -97,26 +158,27 @@ scaleClipperPolygons(ClipperLib::Paths &polygons, const double scale)
     }
 }
 
-ClipperLib::Paths
-_offset(const Polygons &polygons, const float delta,
-    double scale, ClipperLib::JoinType joinType, double miterLimit)
+// Offset the input, returning the result still scaled by the given factor.
+template <class T>
+static ClipperLib::Paths
+_offset_scaled(const T &input, const ClipperLib::EndType endType, const float delta,
+    const double scale, const ClipperLib::JoinType joinType, const double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
-    
-    // scale input
-    scaleClipperPolygons(input, scale);
+    // read and scale input
+    ClipperLib::ClipperOffset &co = _offset_engine(joinType, miterLimit);
+    _add_scaled_paths(co, input, scale, joinType, endType);
     
     // perform offset
-    ClipperLib::ClipperOffset co;
-    if (joinType == jtRound) {
-        co.ArcTolerance = miterLimit;
-    } else {
-        co.MiterLimit = miterLimit;
-    }
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
     ClipperLib::Paths retval;
     co.Execute(retval, (delta*scale));
+    return retval;
+}
+
+ClipperLib::Paths
+_offset(const Polygons &polygons, const float delta,
+    double scale, ClipperLib::JoinType joinType, double miterLimit)
+{
+    ClipperLib::Paths retval = _offset_scaled(polygons, ClipperLib::etClosedPolygon, delta, scale, joinType, miterLimit);
     
     // unscale output
     scaleClipperPolygons(retval, 1/scale);
@@ -127,22 +189,7 @@ ClipperLib::Paths
 _offset(const Polylines &polylines, const float delta,
     double scale, ClipperLib::JoinType joinType, double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polylines);
-    
-    // scale input
-    scaleClipperPolygons(input, scale);
-    
-    // perform offset
-    ClipperLib::ClipperOffset co;
-    if (joinType == jtRound) {
-        co.ArcTolerance = miterLimit;
-    } else {
-        co.MiterLimit = miterLimit;
-    }
-    co.AddPaths(input, joinType, ClipperLib::etOpenButt);
-    ClipperLib::Paths retval;
-    co.Execute(retval, (delta*scale));
+    ClipperLib::Paths retval = _offset_scaled(polylines, ClipperLib::etOpenButt, delta, scale, joinType, miterLimit);
     
     // unscale output
     scaleClipperPolygons(retval, 1/scale);
@@ -211,29 +258,12 @@ ClipperLib::Paths
 _offset2(const Polygons &polygons, const float delta1, const float delta2,
     const double scale, const ClipperLib::JoinType joinType, const double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
-    
-    // scale input
-    scaleClipperPolygons(input, scale);
-    
-    // prepare ClipperOffset object
-    ClipperLib::ClipperOffset co;
-    if (joinType == jtRound) {
-        co.ArcTolerance = miterLimit;
-    } else {
-        co.MiterLimit = miterLimit;
-    }
-    
     // perform first offset
-    ClipperLib::Paths output1;
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
-    co.Execute(output1, (delta1*scale));
+    ClipperLib::Paths retval = _offset_scaled(polygons, ClipperLib::etClosedPolygon, delta1, scale, joinType, miterLimit);
     
-    // perform second offset
-    co.Clear();
-    co.AddPaths(output1, joinType, ClipperLib::etClosedPolygon);
-    ClipperLib::Paths retval;
+    // perform second offset, the output of the first one is already scaled
+    ClipperLib::ClipperOffset &co = _offset_engine(joinType, miterLimit);
+    co.AddPaths(retval, joinType, ClipperLib::etClosedPolygon);
     co.Execute(retval, (delta2*scale));
     
     // unscale output
@@ -263,31 +293,47 @@ offset2_ex(const Polygons &polygons, const float delta1, const float delta2,
     return ClipperPaths_to_Slic3rExPolygons(output);
 }
 
-template <class T>
-T
-_clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+// Same as safety_offset(), reading Slic3r polygons.
+static ClipperLib::Paths
+_safety_offset(const Polygons &polygons)
+{
+    return _offset(polygons, 10.0, CLIPPER_OFFSET_SCALE, jtMiter, 2);
+}
+
+// Load the subject and the clip polygons into the engine. Only the set grown
+// by the safety offset (the clip one, or the subject of a union) is copied.
+static ClipperLib::Clipper&
+_clipper_input(const ClipperLib::ClipType clipType, const Polygons &subject, 
+    const Polygons &clip, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
     // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
+    const bool grow_subject = safety_offset_ && clipType == ClipperLib::ctUnion;
+    const bool grow_clip    = safety_offset_ && clipType != ClipperLib::ctUnion;
+    ClipperLib::Paths grown;
+    if (safety_offset_)
+        grown = _safety_offset(grow_subject ? subject : clip);
     
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Clipper &clipper = _clipper_engine();
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    if (grow_subject)
+        clipper.AddPaths(grown, ClipperLib::ptSubject, true);
+    else
+        _add_paths(clipper, subject, ClipperLib::ptSubject, true);
+    if (grow_clip)
+        clipper.AddPaths(grown, ClipperLib::ptClip, true);
+    else
+        _add_paths(clipper, clip, ClipperLib::ptClip, true);
+    return clipper;
+}
+
+template <class T>
+T
+_clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject, 
+    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+{
+    ClipperLib::Clipper &clipper = _clipper_input(clipType, subject, clip, safety_offset_);
     
     // perform operation
     T retval;
@@ -304,29 +350,15 @@ _clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject,
 inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
     const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
-    
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
-    // Perform the operation with the output to input_subject.
+    ClipperLib::Clipper &clipper = _clipper_input(clipType, subject, clip, safety_offset_);
+    // Perform the operation with the output to Paths.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overlapping edges.
-    clipper.Execute(clipType, input_subject, fillType, fillType);
+    ClipperLib::Paths output;
+    clipper.Execute(clipType, output, fillType, fillType);
     // Perform an additional Union operation to generate the PolyTree ordering.
     clipper.Clear();
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(output, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree retval;
     clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
@@ -337,20 +369,19 @@ _clipper_do(const ClipperLib::ClipType clipType, const Polylines &subject,
     const Polygons &clip, const ClipperLib::PolyFillType fillType,
     const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
     // perform safety offset
-    if (safety_offset_) safety_offset(&input_clip);
+    ClipperLib::Paths grown;
+    if (safety_offset_) grown = _safety_offset(clip);
     
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Clipper &clipper = _clipper_engine();
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    _add_paths(clipper, subject, ClipperLib::ptSubject, false);
+    if (safety_offset_)
+        clipper.AddPaths(grown, ClipperLib::ptClip, true);
+    else
+        _add_paths(clipper, clip, ClipperLib::ptClip, true);
     
     // perform operation
     ClipperLib::PolyTree retval;
@@ -463,6 +494,213 @@ _clipper_ln(ClipperLib::ClipType clipType, const Lines &subject, const Polygons
     return retval;
 }
 
+void
+ClipperIslands::assign(const ExPolygons &expolygons)
+{
+    this->clear();
+    this->_island_end.reserve(expolygons.size());
+    this->_bboxes.reserve(expolygons.size());
+    for (const ExPolygon &expolygon : expolygons) {
+        if (expolygon.contour.points.empty()) continue;
+        this->_paths.push_back(Slic3rMultiPoint_to_ClipperPath(expolygon.contour));
+        for (const Polygon &hole : expolygon.holes)
+            this->_paths.push_back(Slic3rMultiPoint_to_ClipperPath(hole));
+        this->_island_end.push_back(this->_paths.size());
+        this->_bboxes.push_back(expolygon.contour.bounding_box());
+    }
+}
+
+void
+ClipperIslands::clear()
+{
+    this->_paths.clear();
+    this->_island_end.clear();
+    this->_bboxes.clear();
+}
+
+void
+ClipperIslands::overlapping(const BoundingBox &bb, coord_t margin, ClipperLib::Paths* out) const
+{
+    BoundingBox grown = bb;
+    grown.offset(margin);
+    for (size_t i = 0; i < this->_bboxes.size(); ++i) {
+        if (!this->_bboxes[i].overlap(grown)) continue;
+        const size_t begin = (i == 0) ? 0 : this->_island_end[i-1];
+        out->insert(out->end(), this->_paths.begin() + begin, this->_paths.begin() + this->_island_end[i]);
+    }
+}
+
+// safety_offset() grows the clipping polygons by 10 units, miter joins can reach
+// twice as far: islands further than this from the subject can't affect the result.
+constexpr coord_t SAFETY_OFFSET_REACH = 32;
+
+static Polygons
+_clipper_islands(ClipperLib::ClipType clipType, const Polygons &subject,
+    const ClipperIslands &clip, bool safety_offset_)
+{
+    ClipperLib::Paths input_clip;
+    if (!subject.empty()) {
+        BoundingBox bb(subject.front().points);
+        for (const Polygon &polygon : subject) bb.merge(polygon.points);
+        clip.overlapping(bb, safety_offset_ ? SAFETY_OFFSET_REACH : 0, &input_clip);
+    }
+    
+    // nothing to intersect with; a difference still needs the union pass to normalize the subject
+    if (input_clip.empty() && clipType == ClipperLib::ctIntersection)
+        return Polygons();
+    
+    // the islands are never the subject of a union, so only they get the safety offset
+    if (safety_offset_) safety_offset(&input_clip);
+    
+    ClipperLib::Clipper &clipper = _clipper_engine();
+    _add_paths(clipper, subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(input_clip, ClipperLib::ptClip, true);
+    ClipperLib::Paths output;
+    clipper.Execute(clipType, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return ClipperPaths_to_Slic3rMultiPoints<Polygons>(output);
+}
+
+Polygons
+diff(const Polygons &subject, const ClipperIslands &clip, bool safety_offset_)
+{
+    return _clipper_islands(ClipperLib::ctDifference, subject, clip, safety_offset_);
+}
+
+Polygons
+intersection(const Polygons &subject, const ClipperIslands &clip, bool safety_offset_)
+{
+    return _clipper_islands(ClipperLib::ctIntersection, subject, clip, safety_offset_);
+}
+
+namespace {
+// Indices of the subject and clip polygons that have to be clipped together.
+struct ClipperCluster {
+    std::vector<size_t> subject;
+    std::vector<size_t> clip;
+};
+}
+
+// Polygons whose bounding boxes overlap are put in the same cluster. Two clip polygons
+// are never joined directly: they only interact through a subject polygon they both reach.
+// Clip polygons reaching no subject polygon are left out.
+static std::vector<ClipperCluster>
+_clipper_clusters(const Polygons &subject, const Polygons &clip, const coord_t margin)
+{
+    // bounding boxes of the subject polygons followed by those of the clip polygons, grown by margin
+    const size_t n_subject = subject.size();
+    std::vector<BoundingBox> bboxes(n_subject + clip.size());
+    std::vector<size_t> order;
+    order.reserve(bboxes.size());
+    for (size_t i = 0; i < bboxes.size(); ++i) {
+        const Polygon &polygon = (i < n_subject) ? subject[i] : clip[i - n_subject];
+        if (polygon.points.empty()) continue;
+        bboxes[i] = polygon.bounding_box();
+        if (i >= n_subject) bboxes[i].offset(margin);
+        order.push_back(i);
+    }
+    
+    // sweep the boxes along X, joining the overlapping ones
+    std::vector<size_t> parent(bboxes.size());
+    for (size_t i = 0; i < parent.size(); ++i) parent[i] = i;
+    auto find = [&parent](size_t i) {
+        while (parent[i] != i) i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    std::sort(order.begin(), order.end(), [&bboxes](size_t a, size_t b) { return bboxes[a].min.x < bboxes[b].min.x; });
+    std::vector<size_t> active;
+    for (size_t i : order) {
+        const BoundingBox &bb = bboxes[i];
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [&bboxes, &bb](size_t j) { return bboxes[j].max.x < bb.min.x; }), active.end());
+        for (size_t j : active)
+            if ((i < n_subject || j < n_subject) && bb.overlap(bboxes[j]))
+                parent[find(i)] = find(j);
+        active.push_back(i);
+    }
+    
+    // collect the clusters in the order of their first subject polygon
+    std::vector<ClipperCluster> clusters;
+    std::vector<size_t> cluster_id(bboxes.size(), size_t(-1));
+    for (size_t i = 0; i < bboxes.size(); ++i) {
+        if (!bboxes[i].defined) continue;
+        const size_t root = find(i);
+        if (i < n_subject) {
+            if (cluster_id[root] == size_t(-1)) {
+                cluster_id[root] = clusters.size();
+                clusters.push_back(ClipperCluster());
+            }
+            clusters[cluster_id[root]].subject.push_back(i);
+        } else if (cluster_id[root] != size_t(-1)) {
+            clusters[cluster_id[root]].clip.push_back(i - n_subject);
+        }
+    }
+    return clusters;
+}
+
+template <class T>
+static T
+_clipper_partitioned_do(const ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip,
+    const bool safety_offset_, const int threads_count,
+    T (*clipper_fn)(ClipperLib::ClipType, const Polygons&, const Polygons&, bool))
+{
+    const std::vector<ClipperCluster> clusters = _clipper_clusters(subject, clip,
+        safety_offset_ ? SAFETY_OFFSET_REACH : 0);
+    
+    // a single cluster holding everything is plain clipping
+    if (clusters.size() == 1 && clusters.front().subject.size() == subject.size()
+        && clusters.front().clip.size() == clip.size())
+        return clipper_fn(clipType, subject, clip, safety_offset_);
+    
+    // answer the clusters no clip polygon reaches right away, queue the others
+    std::vector<T> results(clusters.size());
+    std::queue<size_t> queue;
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        if (!clusters[i].clip.empty()) {
+            queue.push(i);
+        } else if (clipType == ClipperLib::ctDifference) {
+            for (size_t idx : clusters[i].subject)
+                results[i].push_back(subject[idx]);
+        }
+    }
+    
+    auto clip_cluster = [&](size_t i) {
+        Polygons cluster_subject, cluster_clip;
+        cluster_subject.reserve(clusters[i].subject.size());
+        cluster_clip.reserve(clusters[i].clip.size());
+        for (size_t idx : clusters[i].subject) cluster_subject.push_back(subject[idx]);
+        for (size_t idx : clusters[i].clip)    cluster_clip.push_back(clip[idx]);
+        results[i] = clipper_fn(clipType, cluster_subject, cluster_clip, safety_offset_);
+    };
+    if (threads_count > 1 && queue.size() > 1) {
+        parallelize<size_t>(queue, clip_cluster, threads_count);
+    } else {
+        for (; !queue.empty(); queue.pop()) clip_cluster(queue.front());
+    }
+    
+    T retval;
+    size_t count = 0;
+    for (const T &result : results) count += result.size();
+    retval.reserve(count);
+    for (T &result : results)
+        std::move(result.begin(), result.end(), std::back_inserter(retval));
+    return retval;
+}
+
+Polygons
+_clipper_partitioned(ClipperLib::ClipType clipType, const Polygons &subject,
+    const Polygons &clip, bool safety_offset_, int threads_count)
+{
+    return _clipper_partitioned_do<Polygons>(clipType, subject, clip, safety_offset_, threads_count, &_clipper);
+}
+
+Polylines
+_clipper_pl_partitioned(ClipperLib::ClipType clipType, const Polygons &subject,
+    const Polygons &clip, bool safety_offset_, int threads_count)
+{
+    Polylines (*clipper_fn)(ClipperLib::ClipType, const Polygons&, const Polygons&, bool) = &_clipper_pl;
+    return _clipper_partitioned_do<Polylines>(clipType, subject, clip, safety_offset_, threads_count, clipper_fn);
+}
+
 ClipperLib::PolyTree
 union_pt(const Polygons &subject, bool safety_offset_)
 {
@@ -516,7 +754,7 @@ simplify_polygons(const Polygons &subject, bool preserve_collinear)
     
     ClipperLib::Paths output;
     if (preserve_collinear) {
-        ClipperLib::Clipper c;
+        ClipperLib::Clipper &c = _clipper_engine();
         c.PreserveCollinear(true);
         c.StrictlySimple(true);
         c.AddPaths(input_subject, ClipperLib::ptSubject, true);
@@ -536,15 +774,12 @@ simplify_polygons_ex(const Polygons &subject, bool preserve_collinear)
         return union_ex(simplify_polygons(subject, preserve_collinear));
     }
     
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::PolyTree polytree;
     
-    ClipperLib::Clipper c;
+    ClipperLib::Clipper &c = _clipper_engine();
     c.PreserveCollinear(true);
     c.StrictlySimple(true);
-    c.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    _add_paths(c, subject, ClipperLib::ptSubject, true);
     c.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     
     // convert into ExPolygons
@@ -557,8 +792,7 @@ void safety_offset(ClipperLib::Paths* paths)
     scaleClipperPolygons(*paths, CLIPPER_OFFSET_SCALE);
     
     // perform offset (delta = scale 1e-05)
-    ClipperLib::ClipperOffset co;
-    co.MiterLimit = 2;
+    ClipperLib::ClipperOffset &co = _offset_engine(jtMiter, 2);
     co.AddPaths(*paths, ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
     co.Execute(*paths, 10.0 * CLIPPER_OFFSET_SCALE);
     
@@ -2,7 +2,9 @@
 #define slic3r_ClipperUtils_hpp_
 
 #include <libslic3r.h>
+#include <cstddef>
 #include "clipper.hpp"
+#include "BoundingBox.hpp"
 #include "ExPolygon.hpp"
 #include "Polygon.hpp"
 #include "Surface.hpp"
@@ -21,6 +23,23 @@ namespace Slic3r {
 // further scaling by 10e5 brings us to 
 constexpr auto MAX_COORD = ClipperLib::hiRange / CLIPPER_OFFSET_SCALE;
 
+// Point and ClipperLib::IntPoint are both a pair of 64bit integers, so Slic3r paths are handed
+// to Clipper in place and Clipper paths are copied back into Points with a plain memory copy.
+static_assert(sizeof(coord_t) == sizeof(ClipperLib::cInt), "coord_t has to match ClipperLib::cInt");
+static_assert(sizeof(Point) == sizeof(ClipperLib::IntPoint)
+    && offsetof(Point, x) == offsetof(ClipperLib::IntPoint, X)
+    && offsetof(Point, y) == offsetof(ClipperLib::IntPoint, Y), "Point has to share the layout of ClipperLib::IntPoint");
+
+inline const ClipperLib::IntPoint* to_clipper_points(const Slic3r::Points &points)
+{
+    return reinterpret_cast<const ClipperLib::IntPoint*>(points.data());
+}
+
+inline const Slic3r::Point* from_clipper_points(const ClipperLib::Path &path)
+{
+    return reinterpret_cast<const Slic3r::Point*>(path.data());
+}
+
 //-----------------------------------------------------------
 // legacy code from Clipper documentation
 void AddOuterPolyNodeToExPolygons(ClipperLib::PolyNode& polynode, Slic3r::ExPolygons& expolygons);
@@ -38,6 +57,26 @@ Slic3r::ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &inp
 
 void scaleClipperPolygons(ClipperLib::Paths &polygons, const double scale);
 
+/// ExPolygons converted to Clipper paths once, together with the bounding box of
+/// each island, so that they can serve as the clipping set of many boolean operations.
+/// Islands whose bounding box does not touch the subject are left out of the Clipper run.
+class ClipperIslands
+{
+    public:
+    ClipperIslands() {};
+    ClipperIslands(const Slic3r::ExPolygons &expolygons) { this->assign(expolygons); };
+    void assign(const Slic3r::ExPolygons &expolygons);
+    void clear();
+    bool empty() const { return this->_paths.empty(); };
+    /// Append the paths of the islands whose bounding box, grown by margin, overlaps bb.
+    void overlapping(const BoundingBox &bb, coord_t margin, ClipperLib::Paths* out) const;
+    
+    private:
+    ClipperLib::Paths _paths;
+    std::vector<size_t> _island_end;    ///< island i owns _paths[_island_end[i-1] .. _island_end[i])
+    std::vector<BoundingBox> _bboxes;
+};
+
 // offset Polygons
 ClipperLib::Paths _offset(const Slic3r::Polygons &polygons, const float delta,
     double scale = CLIPPER_OFFSET_SCALE, ClipperLib::JoinType joinType = ClipperLib::jtMiter, 
@@ -210,6 +249,45 @@ union_ex(const Slic3r::Surfaces &subject, bool safety_offset_ = false)
 }
 
 
+// boolean operations against a prepared clipping set
+Slic3r::Polygons diff(const Slic3r::Polygons &subject, const ClipperIslands &clip, bool safety_offset_ = false);
+Slic3r::Polygons intersection(const Slic3r::Polygons &subject, const ClipperIslands &clip, bool safety_offset_ = false);
+
+// boolean operations solved separately on the clusters of polygons whose bounding boxes overlap:
+// subject polygons that no clip polygon can reach are returned untouched by a difference and
+// dropped by an intersection without going through Clipper, which pays off on layers made of
+// many small islands. As untouched polygons are not unioned, the subject is expected to be a
+// clean set (such as the output of another ClipperUtils call).
+// The clusters are clipped by up to threads_count threads.
+Slic3r::Polygons _clipper_partitioned(ClipperLib::ClipType clipType,
+    const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, int threads_count = 1);
+Slic3r::Polylines _clipper_pl_partitioned(ClipperLib::ClipType clipType,
+    const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, int threads_count = 1);
+
+inline Slic3r::Polygons
+diff_partitioned(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, int threads_count = 1)
+{
+    return _clipper_partitioned(ClipperLib::ctDifference, subject, clip, safety_offset_, threads_count);
+}
+
+inline Slic3r::Polygons
+intersection_partitioned(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, int threads_count = 1)
+{
+    return _clipper_partitioned(ClipperLib::ctIntersection, subject, clip, safety_offset_, threads_count);
+}
+
+inline Slic3r::Polylines
+diff_pl_partitioned(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, int threads_count = 1)
+{
+    return _clipper_pl_partitioned(ClipperLib::ctDifference, subject, clip, safety_offset_, threads_count);
+}
+
+inline Slic3r::Polylines
+intersection_pl_partitioned(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, int threads_count = 1)
+{
+    return _clipper_pl_partitioned(ClipperLib::ctIntersection, subject, clip, safety_offset_, threads_count);
+}
+
 ClipperLib::PolyTree union_pt(const Slic3r::Polygons &subject, bool safety_offset_ = false);
 Slic3r::Polygons union_pt_chained(const Slic3r::Polygons &subject, bool safety_offset_ = false);
 void traverse_pt(ClipperLib::PolyNodes &nodes, Slic3r::Polygons* retval);
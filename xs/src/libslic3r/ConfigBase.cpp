@@ -371,6 +371,8 @@ void
 ConfigBase::apply_only(const ConfigBase &other, const t_config_option_keys &opt_keys, bool ignore_nonexistent, bool default_nonexistent) {
     // loop through options and apply them
     for (const t_config_option_key &opt_key : opt_keys) {
+        // DynamicConfig::optptr() throws instead of returning NULL for options it doesn't know
+        if (ignore_nonexistent && this->def != nullptr && !this->def->has(opt_key)) continue;
         ConfigOption* my_opt = this->option(opt_key, true);
         if (opt_key.size() == 0) continue;
         if (my_opt == NULL) {
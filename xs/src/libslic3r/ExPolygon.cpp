@@ -9,9 +9,50 @@
 #include <algorithm>
 #include <cassert>
 #include <list>
+#include <unordered_map>
 
 namespace Slic3r {
 
+namespace {
+struct PointHash {
+    size_t operator()(const Point &p) const {
+        return std::hash<coord_t>()(p.x) * 31 + std::hash<coord_t>()(p.y);
+    }
+};
+
+/// ThickPolylines indexed by their endpoints, so that the ones sharing an endpoint
+/// are found without comparing all the pairs. Reversing a polyline doesn't change
+/// its endpoints, any other change requires the index to be rebuilt.
+class EndpointIndex {
+    public:
+    EndpointIndex(const ThickPolylines &pp) : _pp(pp) { this->rebuild(); };
+    void rebuild() {
+        this->_index.clear();
+        for (size_t i = 0; i < this->_pp.size(); ++i) {
+            this->_index[this->_pp[i].first_point()].push_back(i);
+            if (!this->_pp[i].last_point().coincides_with(this->_pp[i].first_point()))
+                this->_index[this->_pp[i].last_point()].push_back(i);
+        }
+    };
+    /// Indices, in increasing order, of the polylines after i sharing an endpoint with polyline i.
+    void candidates(size_t i, std::vector<size_t>* out) const {
+        out->clear();
+        for (const Point &endpoint : { this->_pp[i].first_point(), this->_pp[i].last_point() }) {
+            const auto it = this->_index.find(endpoint);
+            if (it == this->_index.end()) continue;
+            for (size_t j : it->second)
+                if (j > i) out->push_back(j);
+        }
+        std::sort(out->begin(), out->end());
+        out->erase(std::unique(out->begin(), out->end()), out->end());
+    };
+    
+    private:
+    const ThickPolylines &_pp;
+    std::unordered_map<Point,std::vector<size_t>,PointHash> _index;
+};
+}
+
 ExPolygon::operator Points() const
 {
     Points points;
@@ -214,6 +255,8 @@ ExPolygon::medial_axis(const ExPolygon &bounds, double max_width, double min_wid
     //  and with a next point no more distant than the max width.
     //  Then, we can merge the bit from the first point to the second by following the mean.
 
+    EndpointIndex endpoints(pp);
+    std::vector<size_t> candidates;
     bool changes = true;
     while (changes) {
         changes = false;
@@ -225,7 +268,8 @@ ExPolygon::medial_axis(const ExPolygon &bounds, double max_width, double min_wid
             int best_idx = 0;
 
             // find another polyline starting here
-            for (size_t j = i + 1; j < pp.size(); ++j) {
+            endpoints.candidates(i, &candidates);
+            for (size_t j : candidates) {
                 ThickPolyline& other = pp[j];
                 if (polyline.last_point().coincides_with(other.last_point())) {
                     polyline.reverse();
@@ -307,6 +351,7 @@ ExPolygon::medial_axis(const ExPolygon &bounds, double max_width, double min_wid
                 }
 
                 pp.erase(pp.begin() + best_idx);
+                endpoints.rebuild();
                 changes = true;
             }
         }
@@ -358,7 +403,8 @@ ExPolygon::medial_axis(const ExPolygon &bounds, double max_width, double min_wid
     // We should not connect polylines when more than two meet. 
     // Optimisation of the old algorithm : Select the most "straight line" choice 
     // when we merge with an other line at a point with more than two meet.
-        
+    
+    endpoints.rebuild();  // the endpoints were moved by the extension above
     for (size_t i = 0; i < pp.size(); ++i) {
         ThickPolyline& polyline = pp[i];
         if (polyline.endpoints.first && polyline.endpoints.second) continue; // optimization
@@ -368,7 +414,8 @@ ExPolygon::medial_axis(const ExPolygon &bounds, double max_width, double min_wid
         int best_idx = 0;
         
         // find another polyline starting here
-        for (size_t j = i+1; j < pp.size(); ++j) {
+        endpoints.candidates(i, &candidates);
+        for (size_t j : candidates) {
             ThickPolyline& other = pp[j];
             if (polyline.last_point().coincides_with(other.last_point())) {
                 other.reverse();
@@ -400,6 +447,7 @@ ExPolygon::medial_axis(const ExPolygon &bounds, double max_width, double min_wid
             assert(polyline.width.size() == polyline.points.size()*2 - 2);
                 
             pp.erase(pp.begin() + best_idx);
+            endpoints.rebuild();
         }
     }
     
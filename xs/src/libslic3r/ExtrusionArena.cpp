@@ -0,0 +1,242 @@
+#include "ExtrusionArena.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Slic3r {
+
+size_t
+ExtrusionArena::append(const ExtrusionEntity &entity)
+{
+    Node node;
+    node.loop_role  = elrDefault;
+    node.no_sort    = false;
+    node.first_candidate    = this->seam_candidates.size();
+    node.candidates_count   = 0;
+    node.seam_tolerance     = 0;
+    if (const ExtrusionPath* path = dynamic_cast<const ExtrusionPath*>(&entity)) {
+        node.type   = ntPath;
+        node.first  = this->paths.size();
+        node.count  = 1;
+        this->_append_path(*path);
+    } else if (const ExtrusionLoop* loop = dynamic_cast<const ExtrusionLoop*>(&entity)) {
+        node.type       = ntLoop;
+        node.first      = this->paths.size();
+        node.count      = loop->paths.size();
+        node.loop_role  = loop->role;
+        for (ExtrusionPaths::const_iterator path = loop->paths.begin(); path != loop->paths.end(); ++path)
+            this->_append_path(*path);
+        node.candidates_count   = loop->seam_candidates.size();
+        node.seam_tolerance     = loop->seam_tolerance;
+        this->seam_candidates.insert(this->seam_candidates.end(), loop->seam_candidates.begin(), loop->seam_candidates.end());
+        this->seam_overhangs.insert(this->seam_overhangs.end(), loop->seam_overhangs.begin(), loop->seam_overhangs.end());
+    } else if (const ExtrusionEntityCollection* collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+        // reserve the slots of the members first so that they are contiguous,
+        // the members of nested collections go after them
+        node.type       = ntCollection;
+        node.first      = this->children.size();
+        node.count      = collection->entities.size();
+        node.no_sort    = collection->no_sort;
+        this->children.resize(this->children.size() + node.count);
+        for (size_t i = 0; i < node.count; ++i) {
+            const size_t child = this->append(*collection->entities[i]);
+            this->children[node.first + i] = child;
+        }
+    } else {
+        CONFESS("Invalid argument supplied to ExtrusionArena::append()");
+    }
+    this->nodes.push_back(node);
+    return this->nodes.size() - 1;
+}
+
+void
+ExtrusionArena::_append_path(const ExtrusionPath &path)
+{
+    Path p;
+    p.first_point   = this->points.size();
+    p.points_count  = path.polyline.points.size();
+    p.role          = path.role;
+    p.mm3_per_mm    = path.mm3_per_mm;
+    p.width         = path.width;
+    p.height        = path.height;
+    this->paths.push_back(p);
+    this->points.insert(this->points.end(), path.polyline.points.begin(), path.polyline.points.end());
+}
+
+ExtrusionPath
+ExtrusionArena::path(size_t path_idx) const
+{
+    const Path &p = this->paths[path_idx];
+    ExtrusionPath path(p.role, p.mm3_per_mm, p.width, p.height);
+    path.polyline.points.assign(this->points.begin() + p.first_point, this->points.begin() + p.first_point + p.points_count);
+    return path;
+}
+
+void
+ExtrusionArena::load_path(size_t path_idx, ExtrusionPath* path) const
+{
+    const Path &p = this->paths[path_idx];
+    path->role          = p.role;
+    path->mm3_per_mm    = p.mm3_per_mm;
+    path->width         = p.width;
+    path->height        = p.height;
+    path->polyline.points.assign(this->points.begin() + p.first_point, this->points.begin() + p.first_point + p.points_count);
+}
+
+void
+ExtrusionArena::load_loop(size_t node_idx, ExtrusionLoop* loop) const
+{
+    const Node &node = this->nodes[node_idx];
+    loop->role = node.loop_role;
+    if (loop->paths.size() > node.count)
+        loop->paths.erase(loop->paths.begin() + node.count, loop->paths.end());
+    while (loop->paths.size() < node.count)
+        loop->paths.push_back(ExtrusionPath(erNone));
+    for (size_t i = 0; i < node.count; ++i)
+        this->load_path(node.first + i, &loop->paths[i]);
+    this->_load_seam_candidates(node, loop);
+}
+
+void
+ExtrusionArena::_load_seam_candidates(const Node &node, ExtrusionLoop* loop) const
+{
+    loop->seam_tolerance = node.seam_tolerance;
+    loop->seam_candidates.assign(this->seam_candidates.begin() + node.first_candidate,
+        this->seam_candidates.begin() + node.first_candidate + node.candidates_count);
+    loop->seam_overhangs.assign(this->seam_overhangs.begin() + node.first_candidate,
+        this->seam_overhangs.begin() + node.first_candidate + node.candidates_count);
+}
+
+ExtrusionEntity*
+ExtrusionArena::entity(size_t node_idx) const
+{
+    const Node &node = this->nodes[node_idx];
+    if (node.type == ntPath)
+        return new ExtrusionPath(this->path(node.first));
+    if (node.type == ntLoop) {
+        ExtrusionLoop* loop = new ExtrusionLoop(node.loop_role);
+        loop->paths.reserve(node.count);
+        for (size_t i = node.first; i < node.first + node.count; ++i)
+            loop->paths.push_back(this->path(i));
+        this->_load_seam_candidates(node, loop);
+        return loop;
+    }
+    ExtrusionEntityCollection* collection = new ExtrusionEntityCollection();
+    collection->no_sort = node.no_sort;
+    collection->entities.reserve(node.count);
+    for (size_t i = node.first; i < node.first + node.count; ++i)
+        collection->entities.push_back(this->entity(this->children[i]));
+    return collection;
+}
+
+void
+ExtrusionArena::clear()
+{
+    this->points.clear();
+    this->paths.clear();
+    this->nodes.clear();
+    this->children.clear();
+    this->seam_candidates.clear();
+    this->seam_overhangs.clear();
+}
+
+bool
+ExtrusionArena::can_reverse(size_t node) const
+{
+    switch (this->nodes[node].type) {
+        case ntPath:    return true;
+        case ntLoop:    return false;
+        default:        return !this->nodes[node].no_sort;
+    }
+}
+
+bool
+ExtrusionArena::is_solid_infill(size_t node) const
+{
+    if (this->nodes[node].type == ntCollection) return false;
+    const ExtrusionRole role = this->paths[this->nodes[node].first].role;
+    return role == erBridgeInfill
+        || role == erSolidInfill
+        || role == erTopSolidInfill;
+}
+
+Point
+ExtrusionArena::first_point(size_t node_idx) const
+{
+    const Node &node = this->nodes[node_idx];
+    if (node.type == ntCollection)
+        return this->first_point(this->children[node.first]);
+    return this->_path_first_point(node.first);
+}
+
+Point
+ExtrusionArena::last_point(size_t node_idx) const
+{
+    const Node &node = this->nodes[node_idx];
+    switch (node.type) {
+        case ntPath:    return this->_path_last_point(node.first);
+        case ntLoop:    return this->_path_first_point(node.first);
+        default:        return this->last_point(this->children[node.first + node.count - 1]);
+    }
+}
+
+double
+ExtrusionArena::length(size_t node_idx) const
+{
+    // like ExtrusionEntityCollection, collections have no length of their own
+    const Node &node = this->nodes[node_idx];
+    if (node.type == ntCollection) return 0;
+    double len = 0;
+    for (size_t i = node.first; i < node.first + node.count; ++i) {
+        const Path &path = this->paths[i];
+        for (size_t j = path.first_point + 1; j < path.first_point + path.points_count; ++j)
+            len += this->points[j-1].distance_to(this->points[j]);
+    }
+    return len;
+}
+
+void
+ExtrusionArena::flatten(size_t node_idx, std::vector<size_t>* leaves) const
+{
+    const Node &node = this->nodes[node_idx];
+    if (node.type != ntCollection) {
+        leaves->push_back(node_idx);
+        return;
+    }
+    for (size_t i = node.first; i < node.first + node.count; ++i)
+        this->flatten(this->children[i], leaves);
+}
+
+void
+ExtrusionArena::chained_path_from(Point start_near, std::vector< std::pair<size_t,bool> >* order, bool no_reverse) const
+{
+    // The nodes still to be chained are kept in their original order at the end of
+    // the vector, and candidates are compared exactly like Point::nearest_point_index()
+    // does over the endpoints list built by ExtrusionEntityCollection, so that both
+    // give the same result.
+    for (size_t done = 0; done < order->size(); ++done) {
+        size_t best = done;
+        bool best_reversed = false;
+        double distance = -1;
+        for (size_t i = done; i < order->size(); ++i) {
+            const size_t node = (*order)[i].first;
+            const bool reversible = !no_reverse && this->can_reverse(node);
+            for (int end = 0; end <= 1; ++end) {
+                const Point point = (end == 1 && reversible) ? this->last_point(node) : this->first_point(node);
+                double d = pow(start_near.x - point.x, 2);
+                if (distance != -1 && d > distance) continue;
+                d += pow(start_near.y - point.y, 2);
+                if (distance != -1 && d > distance) continue;
+                best = i;
+                best_reversed = (end == 1 && reversible);
+                distance = d;
+                if (distance < EPSILON) break;
+            }
+            if (distance != -1 && distance < EPSILON) break;
+        }
+        std::rotate(order->begin() + done, order->begin() + best, order->begin() + best + 1);
+        (*order)[done].second = best_reversed;
+        start_near = best_reversed ? this->first_point((*order)[done].first) : this->last_point((*order)[done].first);
+    }
+}
+
+}
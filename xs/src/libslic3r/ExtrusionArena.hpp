@@ -0,0 +1,98 @@
+#ifndef slic3r_ExtrusionArena_hpp_
+#define slic3r_ExtrusionArena_hpp_
+
+#include "libslic3r.h"
+#include "ExtrusionEntity.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+
+/// Flat storage for extrusion entities.
+/// The points of all the paths live in a single pool, paths are compact descriptors
+/// of a range of that pool and loops and collections refer to their members by index.
+/// Packing the extrusions of a layer region costs a few allocations however many
+/// entities it has, and clear() keeps the buffers for the next one.
+/// Entities are referred to by their node index; entity() turns a node back into a
+/// regular ExtrusionEntity for the code that needs one.
+class ExtrusionArena
+{
+    public:
+    enum NodeType { ntPath, ntLoop, ntCollection };
+
+    struct Path {
+        size_t          first_point;
+        size_t          points_count;
+        ExtrusionRole   role;
+        double          mm3_per_mm;
+        float           width;
+        float           height;
+    };
+
+    struct Node {
+        NodeType            type;
+        /// Index of the first path for paths and loops, of the first child in children for collections.
+        size_t              first;
+        /// Number of paths (1 for a path) or of children.
+        size_t              count;
+        ExtrusionLoopRole   loop_role;
+        bool                no_sort;
+        /// Seam candidates of a loop in seam_candidates, see ExtrusionLoop::seam_tolerance.
+        size_t              first_candidate;
+        size_t              candidates_count;
+        double              seam_tolerance;
+    };
+
+    Points              points;
+    std::vector<Path>   paths;
+    std::vector<Node>   nodes;
+    std::vector<size_t> children;
+    Points              seam_candidates;
+    /// One flag for each seam candidate, true if the loop overhangs there.
+    std::vector<char>   seam_overhangs;
+
+    /// Copy an entity (and the members of a collection) into the arena, returns its node.
+    size_t append(const ExtrusionEntity &entity);
+
+    /// Build a regular ExtrusionEntity out of a node. The caller owns the returned object.
+    ExtrusionEntity* entity(size_t node) const;
+    ExtrusionPath path(size_t path_idx) const;
+    /// Copy a path into an existing one, reusing its point buffer.
+    void load_path(size_t path_idx, ExtrusionPath* path) const;
+    /// Copy a loop node into an existing loop, reusing its paths and their point buffers.
+    void load_loop(size_t node, ExtrusionLoop* loop) const;
+
+    void clear();
+    bool empty() const { return this->nodes.empty(); };
+
+    bool is_collection(size_t node) const { return this->nodes[node].type == ntCollection; };
+    bool is_loop(size_t node) const { return this->nodes[node].type == ntLoop; };
+    bool can_reverse(size_t node) const;
+    bool is_solid_infill(size_t node) const;
+    Point first_point(size_t node) const;
+    Point last_point(size_t node) const;
+    double length(size_t node) const;
+
+    /// Append the non-collection nodes contained in a node to leaves, depth first.
+    /// Nothing is copied, so reusing the leaves vector makes this allocation-free.
+    void flatten(size_t node, std::vector<size_t>* leaves) const;
+
+    /// Order the nodes with the same greedy algorithm as ExtrusionEntityCollection::chained_path_from().
+    /// The nodes are reordered in place and the second member of each pair tells
+    /// whether the node has to be extruded reversed.
+    void chained_path_from(Point start_near, std::vector< std::pair<size_t,bool> >* order, bool no_reverse = false) const;
+
+    private:
+    const Point& _path_first_point(size_t path_idx) const { return this->points[this->paths[path_idx].first_point]; };
+    const Point& _path_last_point(size_t path_idx) const {
+        const Path &path = this->paths[path_idx];
+        return this->points[path.first_point + path.points_count - 1];
+    };
+    void _append_path(const ExtrusionPath &path);
+    void _load_seam_candidates(const Node &node, ExtrusionLoop* loop) const;
+};
+
+}
+
+#endif
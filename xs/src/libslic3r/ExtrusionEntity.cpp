@@ -238,6 +238,47 @@ ExtrusionLoop::has_overhang_point(const Point &point) const
     return false;
 }
 
+Points
+ExtrusionLoop::find_seam_candidates(double tolerance) const
+{
+    // the polygon of the loop made counter-clockwise by reverse(), which keeps the first point
+    Polygon polygon = this->polygon();
+    const bool was_clockwise = polygon.is_clockwise();
+    if (was_clockwise && polygon.points.size() > 1)
+        std::reverse(polygon.points.begin() + 1, polygon.points.end());
+    
+    // simplify polygon in order to skip false positives in concave/convex detection
+    // (loop is always ccw as polygon.simplify() only works on ccw polygons)
+    Polygons simplified = polygon.simplify(tolerance);
+    
+    // restore original winding order so that concave and convex detection always happens
+    // on the right/outer side of the polygon
+    if (was_clockwise)
+        for (Polygon &p : simplified)
+            p.reverse();
+    
+    // concave vertices have priority
+    Points candidates;
+    for (const Polygon &p : simplified)
+        append_to(candidates, p.concave_points(PI*4/3));
+    
+    // if no concave points were found, look for convex vertices
+    if (candidates.empty())
+        for (const Polygon &p : simplified)
+            append_to(candidates, p.convex_points(PI*2/3));
+    return candidates;
+}
+
+void
+ExtrusionLoop::precompute_seam_candidates(double tolerance)
+{
+    this->seam_candidates = this->find_seam_candidates(tolerance);
+    this->seam_overhangs.clear();
+    for (const Point &point : this->seam_candidates)
+        this->seam_overhangs.push_back(this->has_overhang_point(point));
+    this->seam_tolerance = tolerance;
+}
+
 Polygons
 ExtrusionLoop::grow() const
 {
@@ -58,6 +58,7 @@ public:
 };
 
 typedef std::vector<ExtrusionEntity*> ExtrusionEntitiesPtr;
+typedef std::vector<const ExtrusionEntity*> ExtrusionEntitiesConstPtr;
 
 class ExtrusionPath : public ExtrusionEntity
 {
@@ -124,6 +125,12 @@ class ExtrusionLoop : public ExtrusionEntity
     public:
     ExtrusionPaths paths;
     ExtrusionLoopRole role;
+    /// Seam candidates computed ahead of the G-code export by precompute_seam_candidates().
+    Points seam_candidates;
+    /// Whether each seam candidate is extruded by a bridging flow.
+    std::vector<bool> seam_overhangs;
+    /// Simplification tolerance the seam candidates were computed with, 0 if they were not.
+    double seam_tolerance {0};
     
     ExtrusionLoop(ExtrusionLoopRole role = elrDefault) : role(role) {};
     ExtrusionLoop(const ExtrusionPaths &paths, ExtrusionLoopRole role = elrDefault)
@@ -147,6 +154,12 @@ class ExtrusionLoop : public ExtrusionEntity
     void clip_end(double distance, ExtrusionPaths* paths) const;
     /// Test, whether the point is extruded by a bridging flow.
     bool has_overhang_point(const Point &point) const;
+    /// The vertices where a seam is best hidden: the concave vertices of the loop
+    /// simplified by tolerance or, if it has none, its convex vertices. Points of
+    /// a counter-clockwise copy of the loop, as GCode extrudes it.
+    Points find_seam_candidates(double tolerance) const;
+    /// Store find_seam_candidates() and their overhang flags in the loop.
+    void precompute_seam_candidates(double tolerance);
     bool is_perimeter() const {
         return this->paths.front().role == erPerimeter
             || this->paths.front().role == erExternalPerimeter
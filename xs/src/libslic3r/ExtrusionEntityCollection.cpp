@@ -227,13 +227,25 @@ ExtrusionEntityCollection::flatten(ExtrusionEntityCollection* retval) const
     for (ExtrusionEntitiesPtr::const_iterator it = this->entities.begin(); it != this->entities.end(); ++it) {
         if ((*it)->is_collection()) {
             ExtrusionEntityCollection* collection = dynamic_cast<ExtrusionEntityCollection*>(*it);
-            retval->append(collection->flatten().entities);
+            collection->flatten(retval);
         } else {
             retval->append(**it);
         }
     }
 }
 
+void
+ExtrusionEntityCollection::flatten(ExtrusionEntitiesConstPtr* retval) const
+{
+    for (ExtrusionEntitiesPtr::const_iterator it = this->entities.begin(); it != this->entities.end(); ++it) {
+        if ((*it)->is_collection()) {
+            dynamic_cast<const ExtrusionEntityCollection*>(*it)->flatten(retval);
+        } else {
+            retval->push_back(*it);
+        }
+    }
+}
+
 ExtrusionEntityCollection
 ExtrusionEntityCollection::flatten() const
 {
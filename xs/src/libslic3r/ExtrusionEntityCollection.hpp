@@ -61,6 +61,10 @@ class ExtrusionEntityCollection : public ExtrusionEntity
     /// Returns a single vector of pointers to all non-collection items contained in this one
     void flatten(ExtrusionEntityCollection* retval) const;
 
+    /// Appends pointers to all non-collection items contained in this one to retval, without copying them.
+    /// They stay owned by this collection.
+    void flatten(ExtrusionEntitiesConstPtr* retval) const;
+
     /// Returns a flattened copy of this ExtrusionEntityCollection. That is, all of the items in its entities vector are not collections.
     /// You should be iterating over flatten().entities if you are interested in the underlying ExtrusionEntities (and don't care about hierarchy).
     ExtrusionEntityCollection flatten() const;
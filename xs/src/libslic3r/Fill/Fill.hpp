@@ -77,6 +77,15 @@ public:
     /// Can this pattern be used for solid infill?
     virtual bool can_solid() const { return false; };
 
+    /// Are the lines filling a surface the lines filling any larger surface,
+    /// clipped to it? This holds for patterns depending only on the layer angle
+    /// and the density, when the lines are not connected and the spacing is not
+    /// adjusted to the surface (density < 1).
+    virtual bool can_clip() const { return false; };
+
+    /// Angle of the pattern in the given layer, in radians.
+    float layer_angle(size_t idx) const { return this->angle + this->_layer_angle(idx); };
+
     /// Perform the fill.
     virtual Polylines fill_surface(const Surface &surface);
     
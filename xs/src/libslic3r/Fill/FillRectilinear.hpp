@@ -13,6 +13,7 @@ public:
     virtual Fill* clone() const { return new FillRectilinear(*this); };
     virtual ~FillRectilinear() {}
     virtual bool can_solid() const { return true; };
+    virtual bool can_clip() const { return true; };
 
 protected:
 	virtual void _fill_surface_single(
@@ -97,6 +98,8 @@ public:
     virtual Fill* clone() const { return new FillCubic(*this); };
     virtual ~FillCubic() {}
     virtual bool can_solid() const { return false; };
+    // the lines are shifted according to Z
+    virtual bool can_clip() const { return false; };
 
 protected:
 	// The grid fill will keep the angle constant between the layers,; see the implementation of Slic3r::Fill.
@@ -303,41 +303,47 @@ GCode::extrude(ExtrusionLoop loop, std::string description, double speed)
 {
     // get a copy; don't modify the orientation of the original loop object otherwise
     // next copies (if any) would not detect the correct orientation
-    
-    // extrude all loops ccw
-    bool was_clockwise = loop.make_counter_clockwise();
+    return this->_extrude_loop(loop, description, speed);
+}
+
+std::string
+GCode::_extrude_loop(ExtrusionLoop &loop, std::string description, double speed)
+{
+    this->_plan_loop(loop, description, speed, &this->_planned);
+    return this->extrude(this->_planned);
+}
+
+void
+GCode::_plan_loop(ExtrusionLoop &loop, std::string description, double speed, PlannedExtrusion* planned)
+{
+    planned->paths.clear();
+    planned->lengths.clear();
+    planned->loop = true;
+    planned->move_inwards = false;
     
     SeamPosition seam_position = this->config.seam_position;
     if (loop.role == elrSkirt) seam_position = spNearest;
+    const bool find_seam = !this->config.spiral_vase
+        && (seam_position == spNearest || seam_position == spAligned || seam_position == spRear);
+    
+    // concave or convex vertices to hide the seam in, usually found in parallel
+    // by Layer::make_perimeters() for the nozzle we print the loop with
+    const double seam_tolerance = scale_(EXTRUDER_CONFIG(nozzle_diameter))/2;
+    const bool precomputed = loop.seam_tolerance == seam_tolerance;
+    Points found;
+    if (find_seam && !precomputed)
+        found = loop.find_seam_candidates(seam_tolerance);
+    const Points &candidates = precomputed ? loop.seam_candidates : found;
+    
+    // extrude all loops ccw
+    bool was_clockwise = loop.make_counter_clockwise();
     
     // find the point of the loop that is closest to the current extruder position
     // or randomize if requested
     Point last_pos = this->last_pos();
     if (this->config.spiral_vase) {
         loop.split_at(last_pos);
-    } else if (seam_position == spNearest || seam_position == spAligned || seam_position == spRear) {
-        const Polygon polygon = loop.polygon();
-        
-        // simplify polygon in order to skip false positives in concave/convex detection
-        // (loop is always ccw as polygon.simplify() only works on ccw polygons)
-        Polygons simplified = polygon.simplify(scale_(EXTRUDER_CONFIG(nozzle_diameter))/2);
-        
-        // restore original winding order so that concave and convex detection always happens
-        // on the right/outer side of the polygon
-        if (was_clockwise)
-            for (Polygon &p : simplified)
-                p.reverse();
-        
-        // concave vertices have priority
-        Points candidates;
-        for (const Polygon &p : simplified)
-            append_to(candidates, p.concave_points(PI*4/3));
-        
-        // if no concave points were found, look for convex vertices
-        if (candidates.empty())
-            for (const Polygon &p : simplified)
-                append_to(candidates, p.convex_points(PI*2/3));
-        
+    } else if (find_seam) {
         // retrieve the last start position for this object
         if (this->layer != NULL) {
             if (seam_position == spRear) {
@@ -350,8 +356,7 @@ GCode::extrude(ExtrusionLoop loop, std::string description, double speed)
         
         Point point;
         if (seam_position == spNearest) {
-            if (candidates.empty()) candidates = polygon.points;
-            last_pos.nearest_point(candidates, &point);
+            last_pos.nearest_point(candidates.empty() ? loop.polygon().points : candidates, &point);
             
             // On 32-bit Linux, Clipper will change some point coordinates by 1 unit
             // while performing simplify_polygons(), thus split_at_vertex() won't 
@@ -359,17 +364,14 @@ GCode::extrude(ExtrusionLoop loop, std::string description, double speed)
             if (!loop.split_at_vertex(point)) loop.split_at(point);
         } else if (!candidates.empty()) {
             Points non_overhang;
-            for (const Point &p : candidates)
-                if (!loop.has_overhang_point(p))
-                    non_overhang.push_back(p);
-            
-            if (!non_overhang.empty())
-                candidates = non_overhang;
+            for (size_t i = 0; i < candidates.size(); ++i)
+                if (!(precomputed ? loop.seam_overhangs[i] : loop.has_overhang_point(candidates[i])))
+                    non_overhang.push_back(candidates[i]);
             
-            last_pos.nearest_point(candidates, &point);
+            last_pos.nearest_point(non_overhang.empty() ? candidates : non_overhang, &point);
             if (!loop.split_at_vertex(point)) loop.split_at(point);  // see note above
         } else {
-            point = last_pos.projection_onto(polygon);
+            point = last_pos.projection_onto(loop.polygon());
             loop.split_at(point);
         }
         if (this->layer != NULL) {
@@ -400,9 +402,9 @@ GCode::extrude(ExtrusionLoop loop, std::string description, double speed)
         : 0;
     
     // get paths
-    ExtrusionPaths paths;
+    ExtrusionPaths &paths = planned->paths;
     loop.clip_end(clip_length, &paths);
-    if (paths.empty()) return "";
+    if (paths.empty()) return;
     
     // apply the small perimeter speed
     if (paths.front().is_perimeter()
@@ -414,50 +416,87 @@ GCode::extrude(ExtrusionLoop loop, std::string description, double speed)
     }
     if (paths.front().role == erExternalPerimeter)
         description = std::string("external ") + description;
-
-    // extrude along the path
-    std::string gcode;
-    for (ExtrusionPaths::const_iterator path = paths.begin(); path != paths.end(); ++path)
-        gcode += this->_extrude(*path, description, speed);
-    
-    // reset acceleration
-    gcode += this->writer.set_acceleration(this->config.default_acceleration.value);
+    planned->description = description;
+    planned->speed = speed;
     
     if (this->wipe.enable)
-        this->wipe.path = paths.front().polyline;  // TODO: don't limit wipe to last path
+        planned->wipe_path = paths.front().polyline;  // TODO: don't limit wipe to last path
     
     // make a little move inwards before leaving loop
     if (paths.back().role == erExternalPerimeter && this->layer != NULL && this->config.perimeters > 1) {
-        // detect angle between last and first segment
-        // the side depends on the original winding order of the polygon (left for contours, right for holes)
-        Point a = paths.front().polyline.points[1];  // second point
-        Point b = *(paths.back().polyline.points.end()-3);       // second to last point
-        if (was_clockwise) {
-            // swap points
-            Point c = a; a = b; b = c;
+        // the last path can be too short to hold the points we need, take them from the previous ones
+        Points tail = paths.back().polyline.points;
+        for (ExtrusionPaths::const_reverse_iterator path = paths.rbegin() + 1; tail.size() < 3 && path != paths.rend(); ++path)
+            tail.insert(tail.begin(), path->polyline.points.begin(), path->polyline.points.end() - 1);
+        if (tail.size() >= 3) {
+            // detect angle between last and first segment
+            // the side depends on the original winding order of the polygon (left for contours, right for holes)
+            Point a = paths.front().polyline.points[1];  // second point
+            Point b = *(tail.end()-3);       // second to last point
+            if (was_clockwise) {
+                // swap points
+                Point c = a; a = b; b = c;
+            }
+            
+            double angle = paths.front().first_point().ccw_angle(a, b) / 3;
+            
+            // turn left if contour, turn right if hole
+            if (was_clockwise) angle *= -1;
+            
+            // create the destination point along the first segment and rotate it
+            // we make sure we don't exceed the segment length because we don't know
+            // the rotation of the second segment so we might cross the object boundary
+            Line first_segment(
+                paths.front().polyline.points[0],
+                paths.front().polyline.points[1]
+            );
+            const double distance = std::min(
+                (double)scale_(EXTRUDER_CONFIG(nozzle_diameter)),
+                first_segment.length()
+            );
+            planned->inwards_point = first_segment.point_at(distance);
+            planned->inwards_point.rotate(angle, first_segment.a);
+            planned->move_inwards = true;
         }
-        
-        double angle = paths.front().first_point().ccw_angle(a, b) / 3;
-        
-        // turn left if contour, turn right if hole
-        if (was_clockwise) angle *= -1;
-        
-        // create the destination point along the first segment and rotate it
-        // we make sure we don't exceed the segment length because we don't know
-        // the rotation of the second segment so we might cross the object boundary
-        Line first_segment(
-            paths.front().polyline.points[0],
-            paths.front().polyline.points[1]
-        );
-        const double distance = std::min(
-            (double)scale_(EXTRUDER_CONFIG(nozzle_diameter)),
-            first_segment.length()
-        );
-        Point point = first_segment.point_at(distance);
-        point.rotate(angle, first_segment.a);
+    }
+    
+    // the paths were simplified as they were extruded, once the inward move was known
+    for (ExtrusionPath &path : paths)
+        GCode::_plan_path(&path, planned);
+}
+
+void
+GCode::_plan_path(ExtrusionPath* path, PlannedExtrusion* planned)
+{
+    path->simplify(SCALED_RESOLUTION);
+    const Points &points = path->polyline.points;
+    for (size_t i = 1; i < points.size(); ++i)
+        planned->lengths.push_back(points[i-1].distance_to(points[i]) * SCALING_FACTOR);
+}
+
+std::string
+GCode::extrude(const PlannedExtrusion &planned)
+{
+    if (planned.paths.empty()) return "";
+    
+    // extrude along the paths
+    std::string gcode;
+    const double* lengths = planned.lengths.data();
+    for (const ExtrusionPath &path : planned.paths) {
+        gcode += this->_emit_path(path, lengths, planned.description, planned.speed);
+        if (!path.polyline.points.empty()) lengths += path.polyline.points.size() - 1;
+    }
+    
+    // reset acceleration
+    gcode += this->writer.set_acceleration(this->config.default_acceleration.value);
+    
+    if (planned.loop) {
+        if (this->wipe.enable)
+            this->wipe.path = planned.wipe_path;
         
         // generate the travel move
-        gcode += this->writer.travel_to_xy(this->point_to_gcode(point), "move inwards before travel");
+        if (planned.move_inwards)
+            gcode += this->writer.travel_to_xy(this->point_to_gcode(planned.inwards_point), "move inwards before travel");
     }
     
     return gcode;
@@ -487,10 +526,50 @@ GCode::extrude(const ExtrusionPath &path, std::string description, double speed)
     return gcode;
 }
 
+std::string
+GCode::extrude(const ExtrusionArena &arena, size_t node, bool reversed, std::string description, double speed)
+{
+    this->plan(arena, node, reversed, description, speed, &this->_planned);
+    return this->extrude(this->_planned);
+}
+
+void
+GCode::plan(const ExtrusionArena &arena, size_t node, bool reversed, std::string description, double speed, PlannedExtrusion* planned)
+{
+    if (arena.is_loop(node)) {
+        arena.load_loop(node, &this->_arena_loop);
+        this->_plan_loop(this->_arena_loop, description, speed, planned);
+        return;
+    } else if (arena.is_collection(node)) {
+        CONFESS("Invalid argument supplied to plan()");
+    }
+    planned->paths.resize(1, this->_arena_path);
+    planned->lengths.clear();
+    planned->description = description;
+    planned->speed = speed;
+    planned->loop = false;
+    planned->move_inwards = false;
+    arena.load_path(arena.nodes[node].first, &planned->paths.front());
+    if (reversed) planned->paths.front().reverse();
+    GCode::_plan_path(&planned->paths.front(), planned);
+}
+
 std::string
 GCode::_extrude(ExtrusionPath path, std::string description, double speed)
+{
+    return this->_extrude_path(path, description, speed);
+}
+
+std::string
+GCode::_extrude_path(ExtrusionPath &path, std::string description, double speed)
 {
     path.simplify(SCALED_RESOLUTION);
+    return this->_emit_path(path, NULL, description, speed);
+}
+
+std::string
+GCode::_emit_path(const ExtrusionPath &path, const double* lengths, std::string description, double speed)
+{
     std::string gcode;
     description = path.is_bridge() ? description + " (bridge)" : description;
     
@@ -578,13 +657,15 @@ GCode::_extrude(ExtrusionPath path, std::string description, double speed)
     double path_length = 0;
     {
         std::string comment = this->config.gcode_comments ? description : "";
-        Lines lines = path.polyline.lines();
-        for (Lines::const_iterator line = lines.begin(); line != lines.end(); ++line) {
-            const double line_length = line->length() * SCALING_FACTOR;
+        const Points &points = path.polyline.points;
+        for (size_t i = 1; i < points.size(); ++i) {
+            const double line_length = (lengths != NULL)
+                ? lengths[i-1]
+                : points[i-1].distance_to(points[i]) * SCALING_FACTOR;
             path_length += line_length;
             
             gcode += this->writer.extrude_to_xy(
-                this->point_to_gcode(line->b),
+                this->point_to_gcode(points[i]),
                 e_per_mm * line_length,
                 comment
             );
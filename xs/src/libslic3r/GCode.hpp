@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include "ExPolygon.hpp"
+#include "ExtrusionArena.hpp"
 #include "GCodeWriter.hpp"
 #include "Layer.hpp"
 #include "MotionPlanner.hpp"
@@ -65,6 +66,22 @@ class Wipe {
     std::string wipe(GCode &gcodegen, bool toolchange = false);
 };
 
+/// An extrusion whose seam, clipping and simplification are decided, see GCode::plan().
+/// Its points are in print coordinates, so the same plan can be extruded at the
+/// origin of every copy of an object.
+struct PlannedExtrusion {
+    ExtrusionPaths paths;
+    /// Length in mm of every segment of the paths, in order.
+    std::vector<double> lengths;
+    std::string description;
+    double speed = -1;
+    /// Loops wipe along their unsimplified first path and may end with a move inwards.
+    bool loop = false;
+    Polyline wipe_path;
+    bool move_inwards = false;
+    Point inwards_point;
+};
+
 class GCode {
     public:
     
@@ -131,6 +148,15 @@ class GCode {
     std::string extrude(const ExtrusionEntity &entity, std::string description = "", double speed = -1);
     std::string extrude(ExtrusionLoop loop, std::string description = "", double speed = -1);
     std::string extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
+    /// Extrude a path or a loop stored in an ExtrusionArena, reversed if requested (paths only).
+    /// The node is loaded into buffers kept from one call to the next, no ExtrusionEntity is allocated.
+    std::string extrude(const ExtrusionArena &arena, size_t node, bool reversed = false, std::string description = "", double speed = -1);
+    /// Decide how a path or a loop stored in an ExtrusionArena is extruded from the
+    /// current position: the seam and clipping of a loop and the simplified points.
+    /// Extrude each plan before making the next one, the seams depend on where the last one ended.
+    void plan(const ExtrusionArena &arena, size_t node, bool reversed, std::string description, double speed, PlannedExtrusion* planned);
+    /// Extrude a plan at the current origin.
+    std::string extrude(const PlannedExtrusion &planned);
     std::string travel_to(const Point &point, ExtrusionRole role, std::string comment);
     bool needs_retraction(const Polyline &travel, ExtrusionRole role = erNone);
     std::string retract(bool toolchange = false);
@@ -141,7 +167,22 @@ class GCode {
     private:
     Point _last_pos;
     bool _last_pos_defined;
+    /// Buffers of extrude(const ExtrusionArena&, ...).
+    ExtrusionPath _arena_path {erNone};
+    ExtrusionLoop _arena_loop;
+    PlannedExtrusion _planned;
     std::string _extrude(ExtrusionPath path, std::string description = "", double speed = -1);
+    /// Same as _extrude(), but works on the path in place.
+    std::string _extrude_path(ExtrusionPath &path, std::string description, double speed);
+    /// Extrude an already simplified path. lengths holds the length in mm of its
+    /// segments, they are computed from the points if it is NULL.
+    std::string _emit_path(const ExtrusionPath &path, const double* lengths, std::string description, double speed);
+    /// Same as extrude(ExtrusionLoop), but works on the loop in place.
+    std::string _extrude_loop(ExtrusionLoop &loop, std::string description, double speed);
+    /// Choose the seam of a loop, clip it and simplify its paths. The loop is modified.
+    void _plan_loop(ExtrusionLoop &loop, std::string description, double speed, PlannedExtrusion* planned);
+    /// Simplify a planned path and append the lengths of its segments.
+    static void _plan_path(ExtrusionPath* path, PlannedExtrusion* planned);
 };
 
 }
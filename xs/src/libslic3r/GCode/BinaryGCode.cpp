@@ -0,0 +1,465 @@
+#include "BinaryGCode.hpp"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#define MINIZ_HEADER_FILE_ONLY
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz/miniz.h"
+
+namespace Slic3r {
+
+namespace BinaryGCode {
+
+// record tags
+constexpr uint8_t tag_raw           = 0xFF;
+constexpr uint8_t tag_raw_no_eol    = 0xFE;
+constexpr uint8_t tag_comment       = 0x80;
+constexpr uint8_t max_args          = 0x7D;
+
+// argument letter flag for numeric (delta-encoded) values
+constexpr uint8_t arg_numeric       = 0x80;
+
+// dictionary references
+constexpr uint64_t string_literal   = 0;
+constexpr uint64_t string_new       = 1;
+constexpr uint64_t string_index     = 2;
+
+// strings longer than this are never stored in the dictionary
+constexpr size_t max_dictionary_string = 255;
+
+constexpr int64_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+static void
+put_varint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += char(value);
+}
+
+static void
+put_uint32(std::string &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out += char((value >> (8*i)) & 0xFF);
+}
+
+static uint32_t
+get_uint32(const unsigned char* in)
+{
+    return uint32_t(in[0]) | (uint32_t(in[1]) << 8) | (uint32_t(in[2]) << 16) | (uint32_t(in[3]) << 24);
+}
+
+static inline uint64_t zigzag(int64_t value)  { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+static inline int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+/// Parse a decimal number in the canonical form -?(0|[1-9][0-9]*)(\.[0-9]+)? into
+/// a fixed point value with max_decimals decimals. Returns false if the number cannot
+/// be reproduced exactly from its fixed point representation.
+static bool
+parse_number(const std::string &str, size_t start, int64_t* value, int* decimals)
+{
+    size_t i = start;
+    const bool negative = i < str.size() && str[i] == '-';
+    if (negative) ++i;
+    const size_t int_start = i;
+    while (i < str.size() && isdigit((unsigned char)str[i])) ++i;
+    const size_t int_digits = i - int_start;
+    if (int_digits == 0 || (int_digits > 1 && str[int_start] == '0')) return false;
+    int dec = 0;
+    if (i < str.size() && str[i] == '.') {
+        ++i;
+        const size_t frac_start = i;
+        while (i < str.size() && isdigit((unsigned char)str[i])) ++i;
+        dec = int(i - frac_start);
+        if (dec == 0) return false;
+    }
+    if (i != str.size() || dec > max_decimals || int_digits + max_decimals > 18) return false;
+
+    int64_t mantissa = 0;
+    for (size_t j = int_start; j < str.size(); ++j)
+        if (str[j] != '.') mantissa = mantissa * 10 + (str[j] - '0');
+    // "-0" and friends would lose their sign
+    if (negative && mantissa == 0) return false;
+
+    *value = (negative ? -mantissa : mantissa) * pow10[max_decimals - dec];
+    *decimals = dec;
+    return true;
+}
+
+static void
+format_number(std::string &out, int64_t value, int decimals)
+{
+    if (value < 0) {
+        out += '-';
+        value = -value;
+    }
+    const int64_t mantissa = value / pow10[max_decimals - decimals];
+    out += std::to_string(mantissa / pow10[decimals]);
+    if (decimals > 0) {
+        const std::string frac = std::to_string(mantissa % pow10[decimals]);
+        out += '.';
+        out.append(decimals - frac.size(), '0');
+        out += frac;
+    }
+}
+
+bool
+is_binary(std::istream &in)
+{
+    const std::streampos pos = in.tellg();
+    char buf[magic_length];
+    in.read(buf, magic_length);
+    const bool binary = in.gcount() == std::streamsize(magic_length)
+        && memcmp(buf, magic, magic_length) == 0;
+    in.clear();
+    in.seekg(pos);
+    return binary;
+}
+
+bool
+is_binary_file(const std::string &file)
+{
+    std::ifstream f(file, std::ios::in | std::ios::binary);
+    return f.good() && is_binary(f);
+}
+
+void
+decode(std::istream &in, std::ostream &out)
+{
+    BinaryGCodeDecoder decoder(in);
+    std::string line;
+    while (decoder.next_line(line)) {
+        out << line;
+        if (decoder.newline()) out << '\n';
+    }
+}
+
+} // namespace BinaryGCode
+
+using namespace BinaryGCode;
+
+BinaryGCodeEncoder::BinaryGCodeEncoder(std::ostream &out, size_t block_size)
+    : _out(&out), _block_size(block_size), _lines(0), _finished(false)
+{
+    this->_last_value.fill(0);
+    this->_block.reserve(block_size + 1024);
+
+    this->_out->write(magic, magic_length);
+    this->_out->put(char(version));
+    this->_out->put(0);
+}
+
+BinaryGCodeEncoder::~BinaryGCodeEncoder()
+{
+    try {
+        this->finish();
+    } catch (...) {}
+}
+
+void
+BinaryGCodeEncoder::finish()
+{
+    if (this->_finished) return;
+    this->_finished = true;
+
+    if (!this->_line.empty()) {
+        ++this->_lines;
+        this->_encode_raw(this->_line, false);
+        this->_line.clear();
+    }
+    this->_flush_block();
+
+    std::string terminator;
+    put_uint32(terminator, 0);
+    put_uint32(terminator, 0);
+    this->_out->write(terminator.data(), terminator.size());
+    this->_out->flush();
+}
+
+BinaryGCodeEncoder::int_type
+BinaryGCodeEncoder::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+    const char c = traits_type::to_char_type(ch);
+    return this->xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+std::streamsize
+BinaryGCodeEncoder::xsputn(const char* s, std::streamsize n)
+{
+    if (this->_finished) return 0;
+
+    const char* end = s + n;
+    while (s < end) {
+        const char* eol = static_cast<const char*>(memchr(s, '\n', end - s));
+        if (eol == nullptr) {
+            this->_line.append(s, end);
+            break;
+        }
+        this->_line.append(s, eol);
+        this->_encode_line(this->_line);
+        this->_line.clear();
+        s = eol + 1;
+
+        if (this->_block.size() >= this->_block_size)
+            this->_flush_block();
+    }
+    return n;
+}
+
+int
+BinaryGCodeEncoder::sync()
+{
+    // Compressing a block on every std::endl would ruin the compression ratio,
+    // only pass the request down to the underlying stream.
+    this->_out->flush();
+    return this->_out->good() ? 0 : -1;
+}
+
+void
+BinaryGCodeEncoder::_encode_line(const std::string &line)
+{
+    ++this->_lines;
+
+    // split off the comment
+    std::string code, comment;
+    const size_t comment_pos = line.find(';');
+    const bool has_comment = comment_pos != std::string::npos;
+    if (has_comment) {
+        code = line.substr(0, comment_pos);
+        comment = line.substr(comment_pos + 1);
+        // comments after a command are separated by exactly one space
+        if (!code.empty()) {
+            if (code.back() != ' ') return this->_encode_raw(line, true);
+            code.pop_back();
+            if (code.empty()) return this->_encode_raw(line, true);
+        }
+    } else {
+        code = line;
+    }
+
+    // split the command and its arguments, reject anything that would not
+    // be reproduced by joining them back with single spaces
+    std::vector<std::string> tokens;
+    if (!code.empty()) {
+        size_t start = 0;
+        while (true) {
+            const size_t space = code.find(' ', start);
+            tokens.push_back(code.substr(start, space - start));
+            if (tokens.back().empty()) return this->_encode_raw(line, true);
+            if (space == std::string::npos) break;
+            start = space + 1;
+        }
+    }
+    if (tokens.size() > size_t(max_args) + 1) return this->_encode_raw(line, true);
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        const unsigned char letter = tokens[i][0];
+        if (letter < 0x21 || letter > 0x7E) return this->_encode_raw(line, true);
+    }
+
+    const size_t args = tokens.empty() ? 0 : tokens.size() - 1;
+    this->_block += char(args | (has_comment ? tag_comment : 0));
+    this->_encode_string(tokens.empty() ? std::string() : tokens.front());
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        const std::string &token = tokens[i];
+        const unsigned char letter = token[0];
+        int64_t value;
+        int decimals;
+        if (parse_number(token, 1, &value, &decimals)) {
+            this->_block += char(letter | arg_numeric);
+            this->_block += char(decimals);
+            put_varint(this->_block, zigzag(value - this->_last_value[letter]));
+            this->_last_value[letter] = value;
+        } else {
+            this->_block += char(letter);
+            put_varint(this->_block, token.size() - 1);
+            this->_block.append(token, 1, std::string::npos);
+        }
+    }
+    if (has_comment)
+        this->_encode_string(comment);
+}
+
+void
+BinaryGCodeEncoder::_encode_raw(const std::string &line, bool newline)
+{
+    this->_block += char(newline ? tag_raw : tag_raw_no_eol);
+    put_varint(this->_block, line.size());
+    this->_block += line;
+}
+
+void
+BinaryGCodeEncoder::_encode_string(const std::string &str)
+{
+    const auto it = this->_dictionary.find(str);
+    if (it != this->_dictionary.end()) {
+        put_varint(this->_block, it->second + string_index);
+        return;
+    }
+    if (str.size() <= max_dictionary_string && this->_dictionary.size() < max_dictionary_size) {
+        put_varint(this->_block, string_new);
+        this->_dictionary.emplace(str, this->_dictionary.size());
+    } else {
+        put_varint(this->_block, string_literal);
+    }
+    put_varint(this->_block, str.size());
+    this->_block += str;
+}
+
+void
+BinaryGCodeEncoder::_flush_block()
+{
+    if (this->_block.empty()) return;
+
+    mz_ulong compressed_size = mz_compressBound(this->_block.size());
+    std::string compressed(compressed_size, '\0');
+    const int status = mz_compress(
+        reinterpret_cast<unsigned char*>(&compressed[0]), &compressed_size,
+        reinterpret_cast<const unsigned char*>(this->_block.data()), this->_block.size());
+    if (status != MZ_OK)
+        throw std::runtime_error("Binary G-code: block compression failed");
+
+    std::string header;
+    put_uint32(header, this->_block.size());
+    put_uint32(header, compressed_size);
+    this->_out->write(header.data(), header.size());
+    this->_out->write(compressed.data(), compressed_size);
+    this->_block.clear();
+}
+
+BinaryGCodeDecoder::BinaryGCodeDecoder(std::istream &in)
+    : _in(&in), _pos(0), _eof(false), _newline(true)
+{
+    this->_last_value.fill(0);
+
+    char header[magic_length + 2];
+    in.read(header, sizeof(header));
+    if (in.gcount() != std::streamsize(sizeof(header)) || memcmp(header, magic, magic_length) != 0)
+        throw std::runtime_error("Binary G-code: invalid header");
+    if (uint8_t(header[magic_length]) != version)
+        throw std::runtime_error("Binary G-code: unsupported format version");
+}
+
+bool
+BinaryGCodeDecoder::next_line(std::string &line)
+{
+    while (this->_pos >= this->_block.size())
+        if (this->_eof || !this->_read_block()) return false;
+
+    line.clear();
+    const uint8_t tag = this->_read_byte();
+    if (tag == tag_raw || tag == tag_raw_no_eol) {
+        line = this->_read_bytes(this->_read_varint());
+        this->_newline = tag == tag_raw;
+        return true;
+    }
+
+    this->_newline = true;
+    const size_t args = tag & ~tag_comment;
+    line = this->_read_string();
+    for (size_t i = 0; i < args; ++i) {
+        const uint8_t letter = this->_read_byte();
+        line += ' ';
+        line += char(letter & ~arg_numeric);
+        if (letter & arg_numeric) {
+            const int decimals = this->_read_byte();
+            if (decimals > max_decimals)
+                throw std::runtime_error("Binary G-code: corrupted number");
+            int64_t &value = this->_last_value[letter & ~arg_numeric];
+            value += unzigzag(this->_read_varint());
+            format_number(line, value, decimals);
+        } else {
+            line += this->_read_bytes(this->_read_varint());
+        }
+    }
+    if (tag & tag_comment) {
+        if (!line.empty()) line += ' ';
+        line += ';';
+        line += this->_read_string();
+    }
+    return true;
+}
+
+bool
+BinaryGCodeDecoder::_read_block()
+{
+    unsigned char header[8];
+    this->_in->read(reinterpret_cast<char*>(header), sizeof(header));
+    if (this->_in->gcount() != std::streamsize(sizeof(header)))
+        throw std::runtime_error("Binary G-code: truncated stream");
+
+    const uint32_t raw_size        = get_uint32(header);
+    const uint32_t compressed_size = get_uint32(header + 4);
+    if (raw_size == 0) {
+        this->_eof = true;
+        return false;
+    }
+
+    std::string compressed(compressed_size, '\0');
+    this->_in->read(&compressed[0], compressed_size);
+    if (this->_in->gcount() != std::streamsize(compressed_size))
+        throw std::runtime_error("Binary G-code: truncated block");
+
+    this->_block.assign(raw_size, '\0');
+    mz_ulong size = raw_size;
+    const int status = mz_uncompress(
+        reinterpret_cast<unsigned char*>(&this->_block[0]), &size,
+        reinterpret_cast<const unsigned char*>(compressed.data()), compressed_size);
+    if (status != MZ_OK || size != raw_size)
+        throw std::runtime_error("Binary G-code: corrupted block");
+    this->_pos = 0;
+    return true;
+}
+
+uint8_t
+BinaryGCodeDecoder::_read_byte()
+{
+    if (this->_pos >= this->_block.size())
+        throw std::runtime_error("Binary G-code: corrupted record");
+    return uint8_t(this->_block[this->_pos++]);
+}
+
+uint64_t
+BinaryGCodeDecoder::_read_varint()
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const uint8_t byte = this->_read_byte();
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("Binary G-code: corrupted varint");
+}
+
+std::string
+BinaryGCodeDecoder::_read_bytes(size_t length)
+{
+    if (length > this->_block.size() - this->_pos)
+        throw std::runtime_error("Binary G-code: corrupted record");
+    std::string out = this->_block.substr(this->_pos, length);
+    this->_pos += length;
+    return out;
+}
+
+std::string
+BinaryGCodeDecoder::_read_string()
+{
+    const uint64_t ref = this->_read_varint();
+    if (ref >= string_index) {
+        if (ref - string_index >= this->_dictionary.size())
+            throw std::runtime_error("Binary G-code: corrupted dictionary reference");
+        return this->_dictionary[ref - string_index];
+    }
+    std::string str = this->_read_bytes(this->_read_varint());
+    if (ref == string_new)
+        this->_dictionary.push_back(str);
+    return str;
+}
+
+}
@@ -0,0 +1,122 @@
+#ifndef slic3r_BinaryGCode_hpp_
+#define slic3r_BinaryGCode_hpp_
+
+#include "libslic3r.h"
+#include <array>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Slic3r {
+
+/*
+Compact binary container for G-code.
+
+The stream starts with an 8 byte header (magic "SL3BGC", format version, reserved byte)
+followed by a sequence of blocks. Each block is a little endian uint32 holding the raw
+size, an uint32 holding the compressed size and the zlib (miniz) compressed payload.
+A block with a raw size of zero terminates the stream.
+
+Inside a block every G-code line is stored as a record:
+ - canonical lines ("CMD ARG ARG ... ;comment") store the command and the comment
+   through a dictionary shared by the whole stream, and numeric arguments as
+   delta-encoded fixed point integers (one accumulator per argument letter);
+ - anything else (odd spacing, non-ASCII argument letters...) is kept verbatim.
+Decoding reproduces the original text byte for byte.
+*/
+
+namespace BinaryGCode {
+    /// Magic bytes at the start of every binary G-code stream.
+    constexpr char magic[] = "SL3BGC";
+    constexpr size_t magic_length = 6;
+    constexpr uint8_t version = 1;
+    /// Default amount of uncompressed record data collected before a block is compressed.
+    constexpr size_t default_block_size = 1 << 16;
+    /// Number of decimals of the fixed point accumulators (numbers with more decimals are stored verbatim).
+    constexpr int max_decimals = 6;
+    /// Maximum number of entries of the command/comment dictionary.
+    constexpr size_t max_dictionary_size = 1 << 16;
+
+    /// Returns true if the stream starts with the binary G-code header. The stream position is left untouched.
+    bool is_binary(std::istream &in);
+    bool is_binary_file(const std::string &file);
+
+    /// Convert a whole binary G-code stream back to text.
+    void decode(std::istream &in, std::ostream &out);
+}
+
+/// Streaming encoder. Plugs into a std::ostream so that the G-code exporter
+/// can write into it exactly as it writes text G-code:
+///     BinaryGCodeEncoder encoder(file);
+///     std::ostream out(&encoder);
+///     out << gcode;
+///     encoder.finish();
+class BinaryGCodeEncoder : public std::streambuf {
+    public:
+    BinaryGCodeEncoder(std::ostream &out, size_t block_size = BinaryGCode::default_block_size);
+    ~BinaryGCodeEncoder();
+
+    /// Encode any pending partial line, flush the last block and write the terminator.
+    /// No more data can be written afterwards.
+    void finish();
+
+    /// Number of G-code lines encoded so far.
+    size_t lines() const { return this->_lines; };
+
+    protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+    private:
+    std::ostream*   _out;
+    size_t          _block_size;
+    std::string     _line;
+    std::string     _block;
+    size_t          _lines;
+    bool            _finished;
+    std::unordered_map<std::string,size_t>  _dictionary;
+    std::array<int64_t,128>                 _last_value;
+
+    void _encode_line(const std::string &line);
+    void _encode_raw(const std::string &line, bool newline);
+    void _encode_string(const std::string &str);
+    void _flush_block();
+};
+
+/// Streaming decoder, returns the original G-code one line at a time.
+class BinaryGCodeDecoder {
+    public:
+    /// Throws std::runtime_error if the stream does not start with a binary G-code header.
+    BinaryGCodeDecoder(std::istream &in);
+
+    /// Read the next line (without the trailing newline). Returns false at the end of the stream.
+    /// Throws std::runtime_error on corrupted input.
+    bool next_line(std::string &line);
+
+    /// Whether the line returned by the last next_line() call was terminated by a newline
+    /// (only the very last line of a stream may not be).
+    bool newline() const { return this->_newline; };
+
+    private:
+    std::istream*               _in;
+    std::string                 _block;
+    size_t                      _pos;
+    bool                        _eof;
+    bool                        _newline;
+    std::vector<std::string>    _dictionary;
+    std::array<int64_t,128>     _last_value;
+
+    bool _read_block();
+    uint8_t _read_byte();
+    uint64_t _read_varint();
+    std::string _read_bytes(size_t length);
+    std::string _read_string();
+};
+
+}
+
+#endif
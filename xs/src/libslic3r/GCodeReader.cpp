@@ -1,4 +1,5 @@
 #include "GCodeReader.hpp"
+#include "GCode/BinaryGCode.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <fstream>
@@ -27,6 +28,15 @@ void GCodeReader::parse_stream(std::istream &gcode, callback_t callback)
         this->parse_line(line, callback);
 }
 
+void
+GCodeReader::parse_binary_stream(std::istream &gcode, callback_t callback)
+{
+    BinaryGCodeDecoder decoder(gcode);
+    std::string line;
+    while (decoder.next_line(line))
+        this->parse_line(line, callback);
+}
+
 void
 GCodeReader::parse_line(std::string line, callback_t callback)
 {
@@ -86,6 +96,12 @@ GCodeReader::parse_line(std::string line, callback_t callback)
 void
 GCodeReader::parse_file(const std::string &file, callback_t callback)
 {
+    if (BinaryGCode::is_binary_file(file)) {
+        std::ifstream f(file, std::ios::in | std::ios::binary);
+        this->parse_binary_stream(f, callback);
+        return;
+    }
+    
     std::ifstream f(file);
     std::string line;
     while (std::getline(f, line))
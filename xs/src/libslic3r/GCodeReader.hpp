@@ -55,7 +55,10 @@ class GCodeReader {
     void apply_config(const PrintConfigBase &config);
     void parse(const std::string &gcode, callback_t callback);
     void parse_stream(std::istream &gcode, callback_t callback);
+    /// Parse G-code written by BinaryGCodeEncoder, callbacks receive the decoded text lines.
+    void parse_binary_stream(std::istream &gcode, callback_t callback);
     void parse_line(std::string line, callback_t callback);
+    /// Parse a text or binary G-code file (the format is detected automatically).
     void parse_file(const std::string &file, callback_t callback);
     
     private:
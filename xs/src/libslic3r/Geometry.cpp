@@ -676,41 +676,44 @@ MedialAxis::build(ThickPolylines* polylines)
     */
     
     // collect valid edges (i.e. prune those not belonging to MAT)
-    // note: this keeps twins, so it inserts twice the number of the valid edges
-    this->valid_edges.clear();
+    // note: this keeps twins, so it marks twice the number of the valid edges
+    const size_t num_edges = this->vd.num_edges();
+    this->valid_edges.assign(num_edges, false);
+    this->thickness.assign(num_edges, std::make_pair(0., 0.));
     {
-        std::set<const VD::edge_type*> seen_edges;
+        std::vector<bool> seen_edges(num_edges, false);
         for (VD::const_edge_iterator edge = this->vd.edges().begin(); edge != this->vd.edges().end(); ++edge) {
             // if we only process segments representing closed loops, none if the
             // infinite edges (if any) would be part of our MAT anyway
             if (edge->is_secondary() || edge->is_infinite()) continue;
         
             // don't re-validate twins
-            if (seen_edges.find(&*edge) != seen_edges.end()) continue;  // TODO: is this needed?
-            seen_edges.insert(&*edge);
-            seen_edges.insert(edge->twin());
+            if (seen_edges[this->edge_index(&*edge)]) continue;  // TODO: is this needed?
+            seen_edges[this->edge_index(&*edge)] = true;
+            seen_edges[this->edge_index(edge->twin())] = true;
             
             if (!this->validate_edge(&*edge)) continue;
-            this->valid_edges.insert(&*edge);
-            this->valid_edges.insert(edge->twin());
+            this->valid_edges[this->edge_index(&*edge)] = true;
+            this->valid_edges[this->edge_index(edge->twin())] = true;
         }
     }
     this->edges = this->valid_edges;
     
-    // iterate through the valid edges to build polylines
-    while (!this->edges.empty()) {
-        const VD::edge_type* edge = *this->edges.begin();
+    // iterate through the valid edges to build polylines, in the order of the diagram
+    for (size_t edge_idx = 0; edge_idx < num_edges; ++edge_idx) {
+        if (!this->edges[edge_idx]) continue;
+        const VD::edge_type* edge = &this->vd.edges()[edge_idx];
         
         // start a polyline
         ThickPolyline polyline;
         polyline.points.push_back(Point( edge->vertex0()->x(), edge->vertex0()->y() ));
         polyline.points.push_back(Point( edge->vertex1()->x(), edge->vertex1()->y() ));
-        polyline.width.push_back(this->thickness[edge].first);
-        polyline.width.push_back(this->thickness[edge].second);
+        polyline.width.push_back(this->thickness[edge_idx].first);
+        polyline.width.push_back(this->thickness[edge_idx].second);
         
         // remove this edge and its twin from the available edges
-        (void)this->edges.erase(edge);
-        (void)this->edges.erase(edge->twin());
+        this->edges[edge_idx] = false;
+        this->edges[this->edge_index(edge->twin())] = false;
         
         // get next points
         this->process_edge_neighbors(edge, &polyline);
@@ -758,7 +761,7 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
         std::vector<const VD::edge_type*> neighbors;
         for (const VD::edge_type* neighbor = twin->rot_next(); neighbor != twin;
             neighbor = neighbor->rot_next()) {
-            if (this->valid_edges.count(neighbor) > 0) neighbors.push_back(neighbor);
+            if (this->valid_edges[this->edge_index(neighbor)]) neighbors.push_back(neighbor);
         }
     
         // if we have a single neighbor then we can continue recursively
@@ -766,14 +769,15 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
             const VD::edge_type* neighbor = neighbors.front();
             
             // break if this is a closed loop
-            if (this->edges.count(neighbor) == 0) return;
+            const size_t neighbor_idx = this->edge_index(neighbor);
+            if (!this->edges[neighbor_idx]) return;
             
             Point new_point(neighbor->vertex1()->x(), neighbor->vertex1()->y());
             polyline->points.push_back(new_point);
-            polyline->width.push_back(this->thickness[neighbor].first);
-            polyline->width.push_back(this->thickness[neighbor].second);
-            (void)this->edges.erase(neighbor);
-            (void)this->edges.erase(neighbor->twin());
+            polyline->width.push_back(this->thickness[neighbor_idx].first);
+            polyline->width.push_back(this->thickness[neighbor_idx].second);
+            this->edges[neighbor_idx] = false;
+            this->edges[this->edge_index(neighbor->twin())] = false;
             edge = neighbor;
         } else if (neighbors.size() == 0) {
             polyline->endpoints.second = true;
@@ -882,8 +886,8 @@ MedialAxis::validate_edge(const VD::edge_type* edge)
     if (w0 > this->max_width && w1 > this->max_width)
         return false;
     
-    this->thickness[edge]         = std::make_pair(w0, w1);
-    this->thickness[edge->twin()] = std::make_pair(w1, w0);
+    this->thickness[this->edge_index(edge)]         = std::make_pair(w0, w1);
+    this->thickness[this->edge_index(edge->twin())] = std::make_pair(w1, w0);
     
     return true;
 }
@@ -59,8 +59,11 @@ class MedialAxis {
     private:
     typedef voronoi_diagram<double> VD;
     VD vd;
-    std::set<const VD::edge_type*> edges, valid_edges;
-    std::map<const VD::edge_type*, std::pair<coordf_t,coordf_t> > thickness;
+    /// Per Voronoi edge state, indexed by edge_index(): whether the edge belongs to the
+    /// medial axis, whether it still has to be walked and its thickness at both ends.
+    std::vector<bool> edges, valid_edges;
+    std::vector<std::pair<coordf_t,coordf_t> > thickness;
+    size_t edge_index(const VD::edge_type* edge) const { return edge - &this->vd.edges().front(); };
     void process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline);
     bool validate_edge(const VD::edge_type* edge);
     const Line& retrieve_segment(const VD::cell_type* cell) const;
@@ -19,6 +19,7 @@ const std::map<ExportFormat,std::string> extensions{
     {TMF, "3mf"},
     {SVG, "svg"},
     {Gcode, "gcode"},
+    {ZIP, "zip"},
 };
 
 const std::map<ExportFormat,bool(*)(const Model&,std::string)> write_model{
@@ -240,6 +240,11 @@ Layer::make_perimeters()
             }
         }
     }
+    
+    // find the seam candidates of the loops while the layers are processed in
+    // parallel, rather than in the serial G-code export
+    FOREACH_LAYERREGION(this, layerm)
+        (*layerm)->precompute_seam_candidates();
 }
 
 /// Iterates over all of the LayerRegion and invokes LayerRegion->make_fill()
@@ -276,6 +281,17 @@ Layer::detect_surfaces_type()
 {
     PrintObject &object = *this->object();
     
+    // Islands of the neighbor layers, as prepared by PrintObject::detect_surfaces_type()
+    // (or converted here when this method is called on its own).
+    ClipperIslands upper_islands_tmp, lower_islands_tmp;
+    auto islands = [](const Layer* layer, ClipperIslands &tmp) -> const ClipperIslands& {
+        if (layer == NULL || !layer->_slices_islands.empty()) return layer == NULL ? tmp : layer->_slices_islands;
+        tmp.assign(layer->slices.expolygons);
+        return tmp;
+    };
+    const ClipperIslands &upper_islands = islands(this->upper_layer, upper_islands_tmp);
+    const ClipperIslands &lower_islands = islands(this->lower_layer, lower_islands_tmp);
+    
     for (size_t region_id = 0; region_id < this->regions.size(); ++region_id) {
         LayerRegion &layerm = *this->regions[region_id];
         
@@ -299,22 +315,20 @@ Layer::detect_surfaces_type()
         // of current layer and upper one)
         SurfaceCollection top;
         if (upper_layer != NULL) {
-            Polygons upper_slices;
+            Polygons upper_diff;
             if (object.config.interface_shells.value) {
                 const LayerRegion* upper_layerm = upper_layer->get_region(region_id);
-                boost::lock_guard<boost::mutex> l(upper_layerm->_slices_mutex);
-                upper_slices = upper_layerm->slices;
+                Polygons upper_slices;
+                {
+                    boost::lock_guard<boost::mutex> l(upper_layerm->_slices_mutex);
+                    upper_slices = upper_layerm->slices;
+                }
+                upper_diff = diff(layerm_slices_surfaces, upper_slices, true);
             } else {
-                upper_slices = upper_layer->slices;
+                upper_diff = diff(layerm_slices_surfaces, upper_islands, true);
             }
         
-            top.append(
-                offset2_ex(
-                    diff(layerm_slices_surfaces, upper_slices, true),
-                    -offs, offs
-                ),
-                stTop
-            );
+            top.append(offset2_ex(upper_diff, -offs, offs), stTop);
         } else {
             // if no upper layer, all surfaces of this one are solid
             // we clone surfaces because we're going to clear the slices collection
@@ -336,7 +350,7 @@ Layer::detect_surfaces_type()
             // Any surface lying on the void is a true bottom bridge (an overhang)
             bottom.append(
                 offset2_ex(
-                    diff(layerm_slices_surfaces, lower_layer->slices, true),
+                    diff(layerm_slices_surfaces, lower_islands, true),
                     -offs, offs
                 ),
                 surface_type_bottom
@@ -352,7 +366,7 @@ Layer::detect_surfaces_type()
                 bottom.append(
                     offset2_ex(
                         diff(
-                            intersection(layerm_slices_surfaces, lower_layer->slices), // supported
+                            intersection(layerm_slices_surfaces, lower_islands), // supported
                             lower_layerm->slices,
                             true
                         ),
@@ -2,6 +2,7 @@
 #define slic3r_Layer_hpp_
 
 #include "libslic3r.h"
+#include "ClipperUtils.hpp"
 #include "Flow.hpp"
 #include "SurfaceCollection.hpp"
 #include "ExtrusionEntityCollection.hpp"
@@ -64,6 +65,8 @@ class LayerRegion
     void prepare_fill_surfaces();
     /// Generates and stores the perimeters and thin fills
     void make_perimeters(const SurfaceCollection &slices, SurfaceCollection* fill_surfaces);
+    /// Stores the seam candidates of the perimeter loops on them, see ExtrusionLoop::precompute_seam_candidates()
+    void precompute_seam_candidates();
     /// Generate infills for a LayerRegion.
     void make_fill();
     /// Processes external surfaces for bridges and top/bottom surfaces
@@ -144,6 +147,9 @@ class Layer {
     protected:
     size_t _id;     ///< sequential number of layer, 0-based
     PrintObject* _object; ///< Associated PrintObject
+    /// this->slices converted to Clipper paths by PrintObject::detect_surfaces_type(),
+    /// so that both neighbouring layers can clip against them without converting them again
+    ClipperIslands _slices_islands;
     
     /// Constructor
     Layer(size_t id, PrintObject *object, coordf_t height, coordf_t print_z,
@@ -70,6 +70,33 @@ LayerRegion::make_perimeters(const SurfaceCollection &slices, SurfaceCollection*
     g.process();
 }
 
+static void
+precompute_seam_candidates(ExtrusionEntityCollection* collection, double tolerance)
+{
+    for (ExtrusionEntity* entity : collection->entities) {
+        if (ExtrusionLoop* loop = dynamic_cast<ExtrusionLoop*>(entity)) {
+            loop->precompute_seam_candidates(tolerance);
+        } else if (ExtrusionEntityCollection* nested = dynamic_cast<ExtrusionEntityCollection*>(entity)) {
+            precompute_seam_candidates(nested, tolerance);
+        }
+    }
+}
+
+/// GCode needs the candidates of the seam positions which look for concave or
+/// convex vertices; the tolerance is the one of the perimeter extruder.
+void
+LayerRegion::precompute_seam_candidates()
+{
+    const PrintConfig &print_config = this->layer()->object()->print()->config;
+    const SeamPosition seam_position = this->layer()->object()->config.seam_position;
+    if (print_config.spiral_vase
+        || (seam_position != spNearest && seam_position != spAligned && seam_position != spRear))
+        return;
+    
+    const double tolerance = scale_(print_config.nozzle_diameter.get_at(this->region()->config.perimeter_extruder - 1))/2;
+    Slic3r::precompute_seam_candidates(&this->perimeters, tolerance);
+}
+
 /// Processes bridges with holes which are internal features.
 /// Detects same-orientation bridges and merges them.
 /// Processes and groups top and bottom surfaces
@@ -129,6 +156,7 @@ LayerRegion::process_external_surfaces()
                 this->layer()->lower_layer->slices,
                 this->flow(frInfill, true).scaled_width()
             );
+            bd.cache = &this->layer()->object()->bridge_angle_cache;
             
             #ifdef SLIC3R_DEBUG
             printf("Processing bridge at layer %zu (z = %f):\n", this->layer()->id(), this->layer()->print_z);
@@ -0,0 +1,314 @@
+#include "LayerStore.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+
+namespace Slic3r {
+
+template <class T>
+static void
+write_pod(std::string* out, const T &value)
+{
+    out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+static void
+write_vector(std::string* out, const std::vector<T> &values)
+{
+    write_pod(out, uint64_t(values.size()));
+    if (!values.empty())
+        out->append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+static void
+write_surfaces(std::string* out, const Surfaces &surfaces)
+{
+    write_pod(out, uint64_t(surfaces.size()));
+    for (const Surface &surface : surfaces) {
+        write_pod(out, surface.surface_type);
+        write_pod(out, surface.thickness);
+        write_pod(out, surface.thickness_layers);
+        write_pod(out, surface.bridge_angle);
+        write_pod(out, surface.extra_perimeters);
+        write_vector(out, surface.expolygon.contour.points);
+        write_pod(out, uint64_t(surface.expolygon.holes.size()));
+        for (const Polygon &hole : surface.expolygon.holes)
+            write_vector(out, hole.points);
+    }
+}
+
+static void
+write_extrusions(std::string* out, const ExtrusionEntityCollection &collection, ExtrusionArena* arena)
+{
+    arena->clear();
+    const size_t root = arena->append(collection);
+    write_vector(out, arena->points);
+    write_vector(out, arena->paths);
+    write_vector(out, arena->nodes);
+    write_vector(out, arena->children);
+    write_vector(out, arena->seam_candidates);
+    write_vector(out, arena->seam_overhangs);
+    write_pod(out, uint64_t(root));
+}
+
+/// Reads back what the write_*() functions above wrote.
+class LayerStoreReader
+{
+    public:
+    LayerStoreReader(const std::string &data) : _pos(data.data()), _end(data.data() + data.size()) {};
+
+    template <class T> T read() {
+        T value;
+        this->_read(&value, sizeof(T));
+        return value;
+    };
+    template <class T> void read_vector(std::vector<T>* values) {
+        values->resize(this->read<uint64_t>());
+        if (!values->empty())
+            this->_read(values->data(), values->size() * sizeof(T));
+    };
+    void read_surfaces(Surfaces* surfaces) {
+        surfaces->clear();
+        const size_t count = this->read<uint64_t>();
+        surfaces->reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            surfaces->push_back(Surface(this->read<SurfaceType>(), ExPolygon()));
+            Surface &surface = surfaces->back();
+            surface.thickness           = this->read<double>();
+            surface.thickness_layers    = this->read<unsigned short>();
+            surface.bridge_angle        = this->read<double>();
+            surface.extra_perimeters    = this->read<unsigned short>();
+            this->read_vector(&surface.expolygon.contour.points);
+            surface.expolygon.holes.resize(this->read<uint64_t>());
+            for (Polygon &hole : surface.expolygon.holes)
+                this->read_vector(&hole.points);
+        }
+    };
+    void read_extrusions(ExtrusionEntityCollection* collection, ExtrusionArena* arena) {
+        this->read_vector(&arena->points);
+        this->read_vector(&arena->paths);
+        this->read_vector(&arena->nodes);
+        this->read_vector(&arena->children);
+        this->read_vector(&arena->seam_candidates);
+        this->read_vector(&arena->seam_overhangs);
+        std::unique_ptr<ExtrusionEntity> entity(arena->entity(this->read<uint64_t>()));
+        static_cast<ExtrusionEntityCollection*>(entity.get())->swap(*collection);
+    };
+
+    private:
+    const char* _pos;
+    const char* _end;
+
+    void _read(void* dst, size_t size) {
+        if (size > size_t(this->_end - this->_pos))
+            throw std::runtime_error("Truncated layer store record");
+        std::memcpy(dst, this->_pos, size);
+        this->_pos += size;
+    };
+};
+
+LayerStore::~LayerStore()
+{
+    this->clear();
+}
+
+void
+LayerStore::spill(Layer* layer, unsigned int fields)
+{
+    unsigned int on_disk;
+    {
+        boost::lock_guard<boost::mutex> l(this->_mutex);
+        std::map<const Layer*,Entry>::const_iterator entry = this->_entries.find(layer);
+        on_disk = (entry == this->_entries.end()) ? 0 : entry->second.fields;
+    }
+
+    // serialize outside of the lock, so that the layers spilled by parallel workers
+    // only wait for each other while writing to the file
+    const unsigned int to_write = fields & ~on_disk;
+    std::string data;
+    if (to_write != 0) {
+        ExtrusionArena arena;
+        LayerStore::_serialize(*layer, to_write, &arena, &data);
+    }
+
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    Entry &entry = this->_entries[layer];
+    if (!data.empty()) this->_write_chunk(&entry, data);
+    LayerStore::_free(layer, to_write | (entry.resident ? entry.fields : 0));
+    entry.fields |= to_write;
+    if (entry.resident) {
+        entry.resident = false;
+        this->_paged_in.erase(std::find(this->_paged_in.begin(), this->_paged_in.end(), layer));
+    }
+}
+
+void
+LayerStore::page_in(Layer* layer)
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    std::map<const Layer*,Entry>::iterator entry = this->_entries.find(layer);
+    if (entry == this->_entries.end() || entry->second.resident) return;
+
+    this->_load(layer, entry->second);
+    entry->second.resident = true;
+    this->_paged_in.push_back(layer);
+
+    while (this->_paged_in.size() > std::max<size_t>(this->window, 1)) {
+        Layer* oldest = this->_paged_in.front();
+        this->_paged_in.pop_front();
+        Entry &oldest_entry = this->_entries[oldest];
+        LayerStore::_free(oldest, oldest_entry.fields);
+        oldest_entry.resident = false;
+    }
+}
+
+void
+LayerStore::release(Layer* layer)
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    std::map<const Layer*,Entry>::iterator entry = this->_entries.find(layer);
+    if (entry == this->_entries.end() || !entry->second.resident) return;
+
+    LayerStore::_free(layer, entry->second.fields);
+    entry->second.resident = false;
+    this->_paged_in.erase(std::find(this->_paged_in.begin(), this->_paged_in.end(), layer));
+}
+
+void
+LayerStore::restore()
+{
+    {
+        boost::lock_guard<boost::mutex> l(this->_mutex);
+        for (std::map<const Layer*,Entry>::const_iterator entry = this->_entries.begin(); entry != this->_entries.end(); ++entry)
+            if (!entry->second.resident)
+                this->_load(const_cast<Layer*>(entry->first), entry->second);
+    }
+    this->clear();
+}
+
+void
+LayerStore::forget(const Layer* layer)
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    if (this->_entries.erase(layer) == 0) return;
+    std::deque<Layer*>::iterator it = std::find(this->_paged_in.begin(), this->_paged_in.end(), layer);
+    if (it != this->_paged_in.end()) this->_paged_in.erase(it);
+}
+
+void
+LayerStore::clear()
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    this->_entries.clear();
+    this->_paged_in.clear();
+    if (this->_file.is_open()) {
+        this->_file.close();
+        boost::system::error_code ec;
+        boost::filesystem::remove(this->_path, ec);
+    }
+    this->_file_size = 0;
+}
+
+bool
+LayerStore::is_resident(const Layer* layer) const
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    std::map<const Layer*,Entry>::const_iterator entry = this->_entries.find(layer);
+    return entry == this->_entries.end() || entry->second.resident;
+}
+
+void
+LayerStore::_write_chunk(Entry* entry, const std::string &data)
+{
+    if (!this->_file.is_open()) {
+        this->_path = (boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("slic3r-%%%%-%%%%-%%%%-%%%%.layers")).string();
+        this->_file.open(this->_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!this->_file)
+            throw std::runtime_error("Cannot create the layer store " + this->_path);
+    }
+    this->_file.seekp(this->_file_size);
+    this->_file.write(data.data(), data.size());
+    if (!this->_file)
+        throw std::runtime_error("Cannot write to the layer store " + this->_path);
+    entry->chunks.push_back(std::make_pair(this->_file_size, data.size()));
+    this->_file_size += data.size();
+}
+
+void
+LayerStore::_load(Layer* layer, const Entry &entry)
+{
+    ExtrusionArena arena;
+    std::string data;
+    for (const std::pair<size_t,size_t> &chunk : entry.chunks) {
+        data.resize(chunk.second);
+        this->_file.seekg(chunk.first);
+        this->_file.read(&data[0], chunk.second);
+        if (!this->_file)
+            throw std::runtime_error("Cannot read from the layer store " + this->_path);
+        LayerStore::_deserialize(layer, data, &arena);
+    }
+}
+
+void
+LayerStore::_free(Layer* layer, unsigned int fields)
+{
+    // swap with empty containers, clear() would keep their capacity
+    for (LayerRegion* layerm : layer->regions) {
+        if (fields & lsfSlices)         Surfaces().swap(layerm->slices.surfaces);
+        if (fields & lsfFillSurfaces)   Surfaces().swap(layerm->fill_surfaces.surfaces);
+        if (fields & lsfThinFills)      ExtrusionEntityCollection().swap(layerm->thin_fills);
+        if (fields & lsfPerimeters)     ExtrusionEntityCollection().swap(layerm->perimeters);
+        if (fields & lsfFills)          ExtrusionEntityCollection().swap(layerm->fills);
+    }
+    if ((fields & lsfSupportFills) && layer->is_support()) {
+        SupportLayer* support_layer = static_cast<SupportLayer*>(layer);
+        ExtrusionEntityCollection().swap(support_layer->support_fills);
+        ExtrusionEntityCollection().swap(support_layer->support_interface_fills);
+    }
+}
+
+void
+LayerStore::_serialize(const Layer &layer, unsigned int fields, ExtrusionArena* arena, std::string* out)
+{
+    write_pod(out, uint32_t(fields));
+    write_pod(out, uint32_t(layer.regions.size()));
+    for (const LayerRegion* layerm : layer.regions) {
+        if (fields & lsfSlices)         write_surfaces(out, layerm->slices.surfaces);
+        if (fields & lsfFillSurfaces)   write_surfaces(out, layerm->fill_surfaces.surfaces);
+        if (fields & lsfThinFills)      write_extrusions(out, layerm->thin_fills, arena);
+        if (fields & lsfPerimeters)     write_extrusions(out, layerm->perimeters, arena);
+        if (fields & lsfFills)          write_extrusions(out, layerm->fills, arena);
+    }
+    if ((fields & lsfSupportFills) && layer.is_support()) {
+        const SupportLayer &support_layer = static_cast<const SupportLayer&>(layer);
+        write_extrusions(out, support_layer.support_fills, arena);
+        write_extrusions(out, support_layer.support_interface_fills, arena);
+    }
+}
+
+void
+LayerStore::_deserialize(Layer* layer, const std::string &data, ExtrusionArena* arena)
+{
+    LayerStoreReader reader(data);
+    const unsigned int fields = reader.read<uint32_t>();
+    if (reader.read<uint32_t>() != layer->regions.size())
+        throw std::runtime_error("Layer store record does not match the layer regions");
+    for (LayerRegion* layerm : layer->regions) {
+        if (fields & lsfSlices)         reader.read_surfaces(&layerm->slices.surfaces);
+        if (fields & lsfFillSurfaces)   reader.read_surfaces(&layerm->fill_surfaces.surfaces);
+        if (fields & lsfThinFills)      reader.read_extrusions(&layerm->thin_fills, arena);
+        if (fields & lsfPerimeters)     reader.read_extrusions(&layerm->perimeters, arena);
+        if (fields & lsfFills)          reader.read_extrusions(&layerm->fills, arena);
+    }
+    if ((fields & lsfSupportFills) && layer->is_support()) {
+        SupportLayer* support_layer = static_cast<SupportLayer*>(layer);
+        reader.read_extrusions(&support_layer->support_fills, arena);
+        reader.read_extrusions(&support_layer->support_interface_fills, arena);
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef slic3r_LayerStore_hpp_
+#define slic3r_LayerStore_hpp_
+
+#include "libslic3r.h"
+#include "ExtrusionArena.hpp"
+#include "Layer.hpp"
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+
+namespace Slic3r {
+
+/// Out-of-core storage for the finished layers of a PrintObject.
+/// Spilling a layer writes the contents selected by a mask of LayerStore::Field
+/// to a temporary file and frees them; page_in() reads them back when the G-code
+/// export reaches the layer. At most `window` spilled layers are paged in at the
+/// same time, the oldest one is released (its memory freed again, its data staying
+/// on disk) when a new one comes in.
+/// The islands (Layer::slices and SupportLayer::support_islands) are small and
+/// needed by the neighbouring layers and by the skirt, so they always stay in memory.
+/// Extrusions are written through an ExtrusionArena, so a layer is stored as a few
+/// flat buffers.
+class LayerStore
+{
+    public:
+    enum Field {
+        lsfSlices       = 1 << 0,   ///< LayerRegion::slices
+        lsfFillSurfaces = 1 << 1,   ///< LayerRegion::fill_surfaces
+        lsfThinFills    = 1 << 2,   ///< LayerRegion::thin_fills
+        lsfPerimeters   = 1 << 3,   ///< LayerRegion::perimeters
+        lsfFills        = 1 << 4,   ///< LayerRegion::fills
+        lsfSupportFills = 1 << 5,   ///< SupportLayer::support_fills and support_interface_fills
+        lsfAll          = (1 << 6) - 1
+    };
+
+    /// Maximum number of spilled layers paged in at the same time.
+    size_t window;
+
+    LayerStore() : window(1), _file_size(0) {};
+    ~LayerStore();
+
+    /// Write the fields of a layer which are not on disk yet, then free them all.
+    /// Safe to call from several threads at once for different layers.
+    void spill(Layer* layer, unsigned int fields = lsfAll);
+    /// Load the spilled fields of a layer back. Does nothing if the layer is not spilled
+    /// or already paged in.
+    void page_in(Layer* layer);
+    /// Free the spilled fields of a paged in layer again.
+    void release(Layer* layer);
+    /// Load every spilled layer back and drop the file.
+    void restore();
+    /// Stop tracking a layer which is about to be deleted.
+    void forget(const Layer* layer);
+    /// Stop tracking all layers and drop the file.
+    void clear();
+
+    /// Whether the spilled fields of the layer are currently in memory.
+    bool is_resident(const Layer* layer) const;
+    /// Number of layers with data on disk.
+    size_t spilled_layers() const { return this->_entries.size(); };
+    /// Size of the data written to disk so far, in bytes.
+    size_t file_size() const { return this->_file_size; };
+
+    private:
+    struct Entry {
+        /// Position and size of the chunks written for this layer, in order.
+        std::vector< std::pair<size_t,size_t> > chunks;
+        /// Fields stored on disk.
+        unsigned int fields;
+        bool resident;
+        Entry() : fields(0), resident(false) {};
+    };
+
+    std::string _path;
+    std::fstream _file;
+    size_t _file_size;
+    std::map<const Layer*,Entry> _entries;
+    /// Layers paged in, oldest first.
+    std::deque<Layer*> _paged_in;
+    mutable boost::mutex _mutex;
+
+    void _write_chunk(Entry* entry, const std::string &data);
+    void _load(Layer* layer, const Entry &entry);
+    static void _free(Layer* layer, unsigned int fields);
+    static void _serialize(const Layer &layer, unsigned int fields, ExtrusionArena* arena, std::string* out);
+    static void _deserialize(Layer* layer, const std::string &data, ExtrusionArena* arena);
+};
+
+}
+
+#endif
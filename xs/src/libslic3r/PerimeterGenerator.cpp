@@ -309,7 +309,7 @@ PerimeterGenerator::process()
                     and use zigzag).  */
                 //FIXME Vojtech: This grows by a rounded extrusion width, not by line spacing,
                 // therefore it may cover the area, but no the volume.
-                last = diff(last, gap_fill.grow());
+                last = diff_partitioned(last, gap_fill.grow());
             }
         }
         
@@ -5,6 +5,7 @@
 #include "Fill/Fill.hpp"
 #include "Flow.hpp"
 #include "Geometry.hpp"
+#include "GCode/BinaryGCode.hpp"
 #include "SupportMaterial.hpp"
 #include <algorithm>
 #include <boost/filesystem.hpp>
@@ -114,7 +115,11 @@ Print::process()
     if (this->status_cb != nullptr)
         this->status_cb(70, "Infilling layers");
     for(auto& obj : this->objects) { obj->infill(); }
-    for(auto& obj : this->objects) { obj->generate_support_material(); }
+    for(auto& obj : this->objects) {
+        obj->generate_support_material();
+        // the layers of this object are finished
+        obj->spill_layers();
+    }
 
     this->make_skirt();
     this->make_brim(); // must follow make_skirt
@@ -133,6 +138,7 @@ Print::make_brim()
     this->state.set_started(psBrim);
     if (this->status_cb != nullptr)
         this->status_cb(88, "Generating brim");
+    ProfilerTimer timer("make_brim");
     this->_make_brim();
     this->state.set_done(psBrim);
 }
@@ -142,6 +148,7 @@ Print::make_skirt()
 {
     if (this->state.is_done(psSkirt)) return;
     this->state.set_started(psSkirt);
+    ProfilerTimer timer("make_skirt");
     
     // prereqs
     for (auto* obj: this->objects) {
@@ -196,8 +203,9 @@ Print::make_skirt()
         }
         
         // get support layers up to this->skirt_height_z
-        for (const auto* layer : object->support_layers) {
+        for (auto* layer : object->support_layers) {
             if (layer->print_z > this->skirt_height_z) break;
+            object->layer_store.page_in(layer);
             for (auto* ee : layer->support_fills)
                 append_to(object_points, ee->as_polyline().points);
             for (auto* ee : layer->support_interface_fills)
@@ -386,11 +394,13 @@ Print::invalidate_state_by_config(const PrintConfigBase &config)
             || opt_key == "first_layer_speed"
             || opt_key == "first_layer_temperature"
             || opt_key == "gcode_arcs"
+            || opt_key == "gcode_binary"
             || opt_key == "gcode_comments"
             || opt_key == "gcode_flavor"
             || opt_key == "infill_acceleration"
             || opt_key == "infill_first"
             || opt_key == "layer_gcode"
+            || opt_key == "layer_memory_window"
             || opt_key == "min_fan_speed"
             || opt_key == "max_fan_speed"
             || opt_key == "min_print_speed"
@@ -489,6 +499,27 @@ Print::invalidate_all_steps()
     return invalidated;
 }
 
+void
+Print::discard_unfinished_steps()
+{
+    for (PrintObject* object : this->objects) {
+        const std::set<PrintObjectStep> steps = object->state.started;
+        for (const PrintObjectStep step : steps) {
+            if (object->state.is_done(step)) continue;
+            if (step == posDetectSurfaces || step == posPrepareInfill) {
+                // these steps modify the slices in place, which only slicing again restores
+                object->invalidate_step(posSlice);
+            } else {
+                object->invalidate_step(step);
+            }
+        }
+    }
+    const std::set<PrintStep> steps = this->state.started;
+    for (const PrintStep step : steps)
+        if (!this->state.is_done(step))
+            this->invalidate_step(step);
+}
+
 // returns true if an object step is done on all objects
 // and there's at least one object
 bool
@@ -689,6 +720,7 @@ Print::export_gcode(std::ostream& output, bool quiet)
     if (this->status_cb != nullptr) 
         this->status_cb(90, "Exporting G-Code...");
     
+    ProfilerTimer timer("export_gcode");
     Slic3r::PrintGCode(*this, output).output();
 }
 
@@ -700,8 +732,22 @@ Print::export_gcode(std::string outfile, bool quiet)
     
     // write G-code to a temporary file in order to make the export atomic
     const std::string tempfile{ outfile + ".tmp" };
-    std::ofstream outstream(tempfile);
-    this->export_gcode(outstream);
+    try {
+        if (this->config.gcode_binary) {
+            std::ofstream outstream(tempfile, std::ios::out | std::ios::binary);
+            BinaryGCodeEncoder encoder(outstream);
+            std::ostream binstream(&encoder);
+            this->export_gcode(binstream);
+            encoder.finish();
+        } else {
+            std::ofstream outstream(tempfile);
+            this->export_gcode(outstream);
+        }
+    } catch (...) {
+        // don't leave a truncated file behind when the export fails or is canceled
+        std::remove(tempfile.c_str());
+        throw;
+    }
     
     // rename the temporary file to the destination file
     // When renaming, some other application (thank you, Windows Explorer) 
@@ -1094,7 +1140,8 @@ Print::_make_brim()
         Polygons object_islands = layer0->slices.contours();
         
         if (!object->support_layers.empty()) {
-            const SupportLayer* support_layer0 = object->get_support_layer(0);
+            SupportLayer* support_layer0 = object->get_support_layer(0);
+            object->layer_store.page_in(support_layer0);
             
             for (const ExtrusionEntity* e : support_layer0->support_fills.entities)
                 append_to(object_islands, offset(e->as_polyline(), grow_distance));
@@ -1318,7 +1365,8 @@ Print::_make_brim()
     if (this->config.interior_brim_width > 0) {
         // collect all island holes to fill
         Polygons holes;
-        for (const PrintObject* object : this->objects) {
+        for (PrintObject* object : this->objects) {
+            object->layer_store.page_in(object->get_layer(0));
             const Layer &layer0 = *object->get_layer(0);
             
             Polygons o_holes = layer0.slices.holes();
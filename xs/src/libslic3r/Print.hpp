@@ -10,6 +10,7 @@
 #include <stdexcept>
 #include <boost/thread.hpp>
 #include "BoundingBox.hpp"
+#include "BridgeDetector.hpp"
 #include "Flow.hpp"
 #include "PrintConfig.hpp"
 #include "Config.hpp"
@@ -19,6 +20,7 @@
 #include "PlaceholderParser.hpp"
 #include "SlicingAdaptive.hpp"
 #include "LayerHeightSpline.hpp"
+#include "LayerStore.hpp"
 #include "SupportMaterial.hpp"
 
 namespace Slic3r {
@@ -110,6 +112,10 @@ class PrintObject
 
     LayerPtrs layers;
     SupportLayerPtrs support_layers;
+    /// Bridge angles already detected on the layers of this object.
+    BridgeAngleCache bridge_angle_cache;
+    /// Finished layers written to disk when layer_memory_window is set.
+    LayerStore layer_store;
     // TODO: Fill* fill_maker        => (is => 'lazy');
     PrintState<PrintObjectStep> state;
     
@@ -183,6 +189,10 @@ class PrintObject
     /// Generate infill for this PrintObject.
     void infill();
 
+    /// Hand the finished layers over to layer_store when layer_memory_window is set.
+    /// They are paged back in by the G-code export.
+    void spill_layers();
+
     /// Kick off the slice process for this object
     void slice();
     /// Find all horizontal shells in  this object
@@ -232,6 +242,10 @@ class Print
     PlaceholderParser placeholder_parser;
     
     std::function<void(int, const std::string&)> status_cb {nullptr};
+    
+    /// Checked between the layers of every step; once canceled, the running
+    /// step throws CanceledException (see PrintJob).
+    CancellationToken cancel_token;
 
     /// Function pointer for the UI side to call post-processing scripts.
     /// Vector is assumed to be the executable script and all arguments.
@@ -278,6 +292,10 @@ class Print
     bool invalidate_step(PrintStep step);
     bool invalidate_all_steps();
     bool step_done(PrintObjectStep step) const;
+    /// Invalidate the steps left half done by a canceled process() or
+    /// export_gcode() so that the next run does them again.
+    void discard_unfinished_steps();
+    void throw_if_canceled() const { this->cancel_token.throw_if_canceled(); };
     
     void add_model_object(ModelObject* model_object, int idx = -1);
     #ifndef SLIC3RXS
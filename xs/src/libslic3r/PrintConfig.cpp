@@ -641,6 +641,12 @@ PrintConfigDef::PrintConfigDef()
     def->cli = "gcode-arcs!";
     def->default_value = new ConfigOptionBool(0);
 
+    def = this->add("gcode_binary", coBool);
+    def->label = __TRANS("Binary G-code");
+    def->tooltip = __TRANS("Write the G-code in a compact, compressed binary format instead of plain text. The output is several times smaller but needs to be decoded before it can be sent to a printer that does not understand it.");
+    def->cli = "gcode-binary!";
+    def->default_value = new ConfigOptionBool(0);
+
     def = this->add("gcode_comments", coBool);
     def->label = __TRANS("Verbose G-code");
     def->tooltip = __TRANS("Enable this to get a commented G-code file, with each line explained by a descriptive text. If you print from SD card, the additional weight of the file could make your firmware slow down.");
@@ -799,6 +805,14 @@ PrintConfigDef::PrintConfigDef()
     def->min = 0;
     def->default_value = new ConfigOptionFloat(0.3);
 
+    def = this->add("layer_memory_window", coInt);
+    def->label = __TRANS("Layers kept in memory");
+    def->tooltip = __TRANS("When set, finished layers are written to a temporary file and only this many of them per object are paged back in memory at a time while the G-code is exported. This bounds the memory used by very tall prints at the cost of some disk I/O. Set to zero to keep all layers in memory.");
+    def->sidetext = __TRANS("layers");
+    def->cli = "layer-memory-window=i";
+    def->min = 0;
+    def->default_value = new ConfigOptionInt(0);
+
     def = this->add("match_horizontal_surfaces", coBool);
     def->label = "Match horizontal surfaces";
     def->tooltip = "Try to match horizontal surfaces during the slicing process. Matching is not guaranteed, very small surfaces and multiple surfaces with low vertical distance might cause bad results.";
@@ -1275,6 +1289,33 @@ PrintConfigDef::PrintConfigDef()
     def->min = 0;
     def->default_value = new ConfigOptionInt(1);
     
+    def = this->add("sla_antialiasing", coInt);
+    def->label = __TRANS("Anti-aliasing samples");
+    def->tooltip = __TRANS("When exporting SLA layers as images, each pixel is sampled on a grid of this many points per side to smooth the edges. Set this to 1 to disable anti-aliasing.");
+    def->cli = "sla-antialiasing=i";
+    def->min = 1;
+    def->max = 16;
+    def->default_value = new ConfigOptionInt(4);
+
+    def = this->add("sla_output_format", coEnum);
+    def->label = __TRANS("SLA output format");
+    def->tooltip = __TRANS("Format of the SLA layers: a single SVG file, or a zip archive holding one grayscale PNG image per layer for DLP/MSLA printers.");
+    def->cli = "sla-output-format=s";
+    def->enum_keys_map = ConfigOptionEnum<SLAOutputFormat>::get_enum_values();
+    def->enum_values.push_back("svg");
+    def->enum_values.push_back("png");
+    def->enum_labels.push_back("SVG");
+    def->enum_labels.push_back("PNG images (zip)");
+    def->default_value = new ConfigOptionEnum<SLAOutputFormat>(slaofSVG);
+
+    def = this->add("sla_pixel_size", coFloat);
+    def->label = __TRANS("Pixel size");
+    def->tooltip = __TRANS("Size of a pixel of the SLA layer images, in the plane of the build platform.");
+    def->sidetext = "mm";
+    def->cli = "sla-pixel-size=f";
+    def->min = 0.001;
+    def->default_value = new ConfigOptionFloat(0.05);
+
     def = this->add("slowdown_below_layer_time", coInt);
     def->label = __TRANS("Slow down if layer print time is below");
     def->tooltip = __TRANS("If layer print time is estimated below this number of seconds, print moves speed will be scaled down to extend duration to this value.");
@@ -1935,7 +1976,7 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     
     def = this->add("export_sla_svg", coBool);
     def->label = __TRANS("Export SVG for SLA");
-    def->tooltip = __TRANS("Slice the model and export SLA printing layers as SVG.");
+    def->tooltip = __TRANS("Slice the model and export SLA printing layers as SVG, or as PNG images when sla_output_format is png.");
     def->cli = "export-sla-svg|sla";
     def->default_value = new ConfigOptionBool(false);
 
@@ -2111,6 +2152,11 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->tooltip = __TRANS("The file where the output will be written (if not specified, it will be based on the input file).");
     def->cli = "output|o";
     
+    def = this->add("profile_out", coString);
+    def->label = __TRANS("Profile output file");
+    def->tooltip = __TRANS("Time the slicing steps and write them to the specified file as a Chrome trace (JSON). A summary is logged as well.");
+    def->cli = "profile-out";
+    
     #ifdef USE_WX
     def = this->add("autosave", coString);
     def->label = __TRANS("Autosave");
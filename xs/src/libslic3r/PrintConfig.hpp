@@ -48,6 +48,10 @@ enum SeamPosition {
     spRandom, spNearest, spAligned, spRear
 };
 
+enum SLAOutputFormat {
+    slaofSVG, slaofPNG,
+};
+
 template<> inline t_config_enum_values ConfigOptionEnum<GCodeFlavor>::get_enum_values() {
     t_config_enum_values keys_map;
     keys_map["reprap"]          = gcfRepRap;
@@ -105,6 +109,13 @@ template<> inline t_config_enum_values ConfigOptionEnum<SeamPosition>::get_enum_
     return keys_map;
 }
 
+template<> inline t_config_enum_values ConfigOptionEnum<SLAOutputFormat>::get_enum_values() {
+    t_config_enum_values keys_map;
+    keys_map["svg"]                 = slaofSVG;
+    keys_map["png"]                 = slaofPNG;
+    return keys_map;
+}
+
 // Defines each and every confiuration option of Slic3r, including the properties of the GUI dialogs.
 // Does not store the actual values, but defines default values.
 class PrintConfigDef : public ConfigDef
@@ -453,9 +464,11 @@ class PrintConfig : public GCodeConfig
     ConfigOptionFloatOrPercent      first_layer_speed;
     ConfigOptionInts                first_layer_temperature;
     ConfigOptionBool                gcode_arcs;
+    ConfigOptionBool                gcode_binary;
     ConfigOptionFloat               infill_acceleration;
     ConfigOptionBool                infill_first;
     ConfigOptionFloat               interior_brim_width;
+    ConfigOptionInt                 layer_memory_window;
     ConfigOptionInt                 max_fan_speed;
     ConfigOptionFloats              max_layer_height;
     ConfigOptionInt                 min_fan_speed;
@@ -517,9 +530,11 @@ class PrintConfig : public GCodeConfig
         OPT_PTR(first_layer_speed);
         OPT_PTR(first_layer_temperature);
         OPT_PTR(gcode_arcs);
+        OPT_PTR(gcode_binary);
         OPT_PTR(infill_acceleration);
         OPT_PTR(infill_first);
         OPT_PTR(interior_brim_width);
+        OPT_PTR(layer_memory_window);
         OPT_PTR(max_fan_speed);
         OPT_PTR(max_layer_height);
         OPT_PTR(min_fan_speed);
@@ -619,6 +634,9 @@ class SLAPrintConfig
     ConfigOptionFloatOrPercent      perimeter_extrusion_width;
     ConfigOptionInt                 raft_layers;
     ConfigOptionFloat               raft_offset;
+    ConfigOptionInt                 sla_antialiasing;
+    ConfigOptionEnum<SLAOutputFormat> sla_output_format;
+    ConfigOptionFloat               sla_pixel_size;
     ConfigOptionBool                support_material;
     ConfigOptionFloatOrPercent      support_material_extrusion_width;
     ConfigOptionFloat               support_material_spacing;
@@ -634,6 +652,9 @@ class SLAPrintConfig
         OPT_PTR(perimeter_extrusion_width);
         OPT_PTR(raft_layers);
         OPT_PTR(raft_offset);
+        OPT_PTR(sla_antialiasing);
+        OPT_PTR(sla_output_format);
+        OPT_PTR(sla_pixel_size);
         OPT_PTR(support_material);
         OPT_PTR(support_material_extrusion_width);
         OPT_PTR(support_material_spacing);
@@ -248,6 +248,7 @@ PrintGCode::output()
                             _print_first_layer_temperature(false);
                         }
                     }
+                    object.layer_store.page_in(layer);
                     this->process_layer(obj_idx, layer, Points({copy}));
                 }
                 this->flush_filters();
@@ -292,7 +293,9 @@ PrintGCode::output()
         //  call process_layers in the order given by obj_idx
         for (const auto& print_z : z) {
             for (const auto& idx : obj_idx) {
-                for (const auto* layer : layers[print_z][idx] ) {
+                for (auto* layer : layers[print_z][idx] ) {
+                    // bring the layer back in memory if it was spilled to disk
+                    layer->object()->layer_store.page_in(layer);
                     this->process_layer(idx, layer, layer->object()->_shifted_copies);
                 }
             }
@@ -378,6 +381,8 @@ PrintGCode::filter(const std::string& in, bool wait)
 void
 PrintGCode::process_layer(size_t idx, const Layer* layer, const Points& copies)
 {
+    _print.throw_if_canceled();
+    ProfilerTimer timer("process_layer", "gcode", layer->id());
     std::string gcode {""};
 
     const PrintObject& obj { *layer->object() };
@@ -515,7 +520,9 @@ PrintGCode::process_layer(size_t idx, const Layer* layer, const Points& copies)
             const Flow skirt_flow { _print.skirt_flow() };
 
             // distribute skirt loops across all extruders in layer 0
-            const auto skirt_loops = _print.skirt.flatten().entities;
+            // keep the flattened collection alive, it owns the loops
+            const ExtrusionEntityCollection skirt = _print.skirt.flatten();
+            const auto& skirt_loops = skirt.entities;
             for (size_t i = 0; i < skirt_loops.size(); ++i) {
 
                 // when printing layers > 0 ignore 'min_skirt_length' and
@@ -564,6 +571,94 @@ PrintGCode::process_layer(size_t idx, const Layer* layer, const Points& copies)
         _gcodegen.avoid_crossing_perimeters.disable_once = true;
     }
 
+    // We now define a strategy for building perimeters and fills. The separation
+    // between regions doesn't matter in terms of printing order, as we follow
+    // another logic instead:
+    // - we group all extrusions by extruder so that we minimize toolchanges
+    // - we start from the last used extruder
+    // - for each extruder, we group extrusions by island
+    // - for each island, we extrude perimeters first, unless user set the infill_first
+    //   option
+    // (Still, we have to keep track of regions because we need to apply their config)
+
+    // group extrusions by extruder and then by island; the extrusions are packed
+    // into this->_extrusions once for all copies and referred to by their node index
+    //       extruder        island
+    std::map<size_t,std::map<size_t,
+        //                  region
+        std::tuple<std::map<size_t,std::vector<size_t>>, // perimeters
+                   std::map<size_t,std::vector<size_t>>>  // infill
+    >> by_extruder;
+    this->_extrusions.clear();
+    std::vector<size_t> leaves;
+
+    // cache bounding boxes of layer slices
+    std::vector<BoundingBox> layer_slices_bb;
+    std::transform(layer->slices.cbegin(), layer->slices.cend(), std::back_inserter(layer_slices_bb), [] (const ExPolygon& s)-> BoundingBox { return s.bounding_box(); });
+    auto point_inside_surface = [&layer_slices_bb, &layer] (size_t i, Point point) -> bool {
+        const BoundingBox& bbox { layer_slices_bb.at(i) };
+        return bbox.contains(point) && layer->slices.at(i).contour.contains(point);
+    };
+    const size_t n_slices { layer->slices.size() };
+
+    for (auto region_id = 0U; region_id < _print.regions.size(); ++region_id) {
+        const LayerRegion* layerm;
+        try {
+            layerm = layer->get_region(region_id); // we promise to be good and not give this to anyone who will modify it
+        } catch (std::out_of_range &e) {
+            continue; // if no regions, bail;
+        }
+        const PrintRegion* region { _print.get_region(region_id) };
+        // process perimeters
+        {
+            auto extruder_id = region->config.perimeter_extruder-1;
+            leaves.clear();
+            this->_extrusions.flatten(this->_extrusions.append(layerm->perimeters), &leaves);
+            for(const auto perimeter_coll : leaves) {
+
+                if(this->_extrusions.length(perimeter_coll) == 0) continue;  // this shouldn't happen but first_point() would fail
+
+                // perimeter_coll is an ExtrusionPath::Collection object representing a single slice
+                for(auto i = 0U; i < n_slices; i++){
+                    if (// perimeter_coll->first_point does not fit inside any slice
+                        i == n_slices - 1
+                        // perimeter_coll->first_point fits inside ith slice
+                        || point_inside_surface(i, this->_extrusions.first_point(perimeter_coll))) {
+                        std::get<0>(by_extruder[extruder_id][i])[region_id].push_back(perimeter_coll);
+                        break;
+                    }
+                }
+            }
+        }
+
+        // process infill
+        // $layerm->fills is a collection of ExtrusionPath::Collection objects, each one containing
+        // the ExtrusionPath objects of a certain infill "group" (also called "surface"
+        // throughout the code). We can redefine the order of such Collections but we have to
+        // do each one completely at once.
+        leaves.clear();
+        this->_extrusions.flatten(this->_extrusions.append(layerm->fills), &leaves);
+        for(const auto fill : leaves) {
+            if(this->_extrusions.length(fill) == 0) continue;  // this shouldn't happen but first_point() would fail
+
+            auto extruder_id = this->_extrusions.is_solid_infill(fill)
+                ? region->config.solid_infill_extruder-1
+                : region->config.infill_extruder-1;
+
+            // $fill is an ExtrusionPath::Collection object
+            for(auto i = 0U; i < n_slices; i++){
+                if (i == n_slices - 1
+                    || point_inside_surface(i, this->_extrusions.first_point(fill))) {
+                    std::get<1>(by_extruder[extruder_id][i])[region_id].push_back(fill);
+                    break;
+                }
+            }
+        }
+    }
+
+    // support material chained on the first copy
+    ExtrusionEntityCollection support_interface_paths, support_paths;
+
     auto copy_idx = 0U;
     for (const auto& copy : copies) {
         if (config.label_printed_objects) {
@@ -581,127 +676,51 @@ PrintGCode::process_layer(size_t idx, const Layer* layer, const Points& copies)
         // and also because we avoid travelling on other things when printing it
         if(layer->is_support()) {
             const SupportLayer* slayer = dynamic_cast<const SupportLayer*>(layer);
-            ExtrusionEntityCollection paths;
             if (slayer->support_interface_fills.size() > 0) {
                 gcode += _gcodegen.set_extruder(obj.config.support_material_interface_extruder - 1);
-                slayer->support_interface_fills.chained_path_from(_gcodegen.last_pos(), &paths, false);
-                for (const auto& path : paths) {
+                if (copy_idx == 0)
+                    slayer->support_interface_fills.chained_path_from(_gcodegen.last_pos(), &support_interface_paths, false);
+                for (const auto& path : support_interface_paths) {
                     gcode += _gcodegen.extrude(*path, "support material interface", obj.config.get_abs_value("support_material_interface_speed"));
                 }
             }
             if (slayer->support_fills.size() > 0) {
                 gcode += _gcodegen.set_extruder(obj.config.support_material_extruder - 1);
-                slayer->support_fills.chained_path_from(_gcodegen.last_pos(), &paths, false);
-                for (const auto& path : paths) {
+                if (copy_idx == 0)
+                    slayer->support_fills.chained_path_from(_gcodegen.last_pos(), &support_paths, false);
+                for (const auto& path : support_paths) {
                     gcode += _gcodegen.extrude(*path, "support material", obj.config.get_abs_value("support_material_speed"));
                 }
             }
         }
-        // We now define a strategy for building perimeters and fills. The separation
-        // between regions doesn't matter in terms of printing order, as we follow
-        // another logic instead:
-        // - we group all extrusions by extruder so that we minimize toolchanges
-        // - we start from the last used extruder
-        // - for each extruder, we group extrusions by island
-        // - for each island, we extrude perimeters first, unless user set the infill_first
-        //   option
-        // (Still, we have to keep track of regions because we need to apply their config)
-
-        // group extrusions by extruder and then by island
-        //       extruder        island
-        std::map<size_t,std::map<size_t,
-            //                  region
-            std::tuple<std::map<size_t,ExtrusionEntityCollection>, // perimeters
-                       std::map<size_t,ExtrusionEntityCollection>>  // infill
-        >> by_extruder;
-
-        // cache bounding boxes of layer slices
-        std::vector<BoundingBox> layer_slices_bb;
-        std::transform(layer->slices.cbegin(), layer->slices.cend(), std::back_inserter(layer_slices_bb), [] (const ExPolygon& s)-> BoundingBox { return s.bounding_box(); });
-        auto point_inside_surface = [&layer_slices_bb, &layer] (size_t i, Point point) -> bool {
-            const BoundingBox& bbox { layer_slices_bb.at(i) };
-            return bbox.contains(point) && layer->slices.at(i).contour.contains(point);
-        };
-        const size_t n_slices { layer->slices.size() };
-
-        for (auto region_id = 0U; region_id < _print.regions.size(); ++region_id) {
-            const LayerRegion* layerm;
-            try {
-                layerm = layer->get_region(region_id); // we promise to be good and not give this to anyone who will modify it
-            } catch (std::out_of_range &e) {
-                continue; // if no regions, bail;
-            }
-            const PrintRegion* region { _print.get_region(region_id) };
-            // process perimeters
-            {
-                auto extruder_id = region->config.perimeter_extruder-1;
-                // Casting away const just to avoid double dereferences
-                for(const auto* perimeter_coll : layerm->perimeters.flatten().entities) {
-
-                    if(perimeter_coll->length() == 0) continue;  // this shouldn't happen but first_point() would fail
-
-                    // perimeter_coll is an ExtrusionPath::Collection object representing a single slice
-                    for(auto i = 0U; i < n_slices; i++){
-                        if (// perimeter_coll->first_point does not fit inside any slice
-                            i == n_slices - 1
-                            // perimeter_coll->first_point fits inside ith slice
-                            || point_inside_surface(i, perimeter_coll->first_point())) {
-                            std::get<0>(by_extruder[extruder_id][i])[region_id].append(*perimeter_coll);
-                            break;
-                        }
-                    }
-                }
-            }
-
-            // process infill
-            // $layerm->fills is a collection of ExtrusionPath::Collection objects, each one containing
-            // the ExtrusionPath objects of a certain infill "group" (also called "surface"
-            // throughout the code). We can redefine the order of such Collections but we have to
-            // do each one completely at once.
-            for(auto* fill : layerm->fills.flatten().entities) {
-                if(fill->length() == 0) continue;  // this shouldn't happen but first_point() would fail
-
-                auto extruder_id = fill->is_solid_infill()
-                    ? region->config.solid_infill_extruder-1
-                    : region->config.infill_extruder-1;
-
-                // $fill is an ExtrusionPath::Collection object
-                for(auto i = 0U; i < n_slices; i++){
-                    if (i == n_slices - 1
-                        || point_inside_surface(i, fill->first_point())) {
-                        std::get<1>(by_extruder[extruder_id][i])[region_id].append(*fill);
-                        break;
-                    }
-                }
-            }
-        }
-
         // tweak extruder ordering to save toolchanges
-
-        auto last_extruder = _gcodegen.writer.extruder()->id;
-        if (by_extruder.count(last_extruder)) {
-            for(auto &island : by_extruder[last_extruder]) {
+        // the seams and the order of the extrusions are decided on the first copy,
+        // the other copies only translate them
+        auto extrude_island_groups = [this, copy_idx] (size_t extruder_id, std::map<size_t, std::tuple<std::map<size_t,std::vector<size_t>>, std::map<size_t,std::vector<size_t>>>> &islands) {
+            if (copy_idx > 0)
+                return this->_replay_plan(extruder_id);
+            std::string gcode = "";
+            for(auto &island : islands) {
                if (_print.config.infill_first()) {
-                    gcode += this->_extrude_infill(std::get<1>(island.second));
-                    gcode += this->_extrude_perimeters(std::get<0>(island.second));
+                    gcode += this->_extrude_infill(extruder_id, std::get<1>(island.second));
+                    gcode += this->_extrude_perimeters(extruder_id, std::get<0>(island.second));
                 } else {
-                    gcode += this->_extrude_perimeters(std::get<0>(island.second));
-                    gcode += this->_extrude_infill(std::get<1>(island.second));
+                    gcode += this->_extrude_perimeters(extruder_id, std::get<0>(island.second));
+                    gcode += this->_extrude_infill(extruder_id, std::get<1>(island.second));
                 }
             }
+            return gcode;
+        };
+        if (copy_idx == 0) this->_layer_plan_size = 0;
+
+        auto last_extruder = _gcodegen.writer.extruder()->id;
+        if (by_extruder.count(last_extruder)) {
+            gcode += extrude_island_groups(last_extruder, by_extruder[last_extruder]);
         }
         for(auto &pair : by_extruder) {
             if(pair.first == last_extruder)continue;
             gcode += _gcodegen.set_extruder(pair.first);
-            for(auto &island : pair.second) {
-               if (_print.config.infill_first()) {
-                    gcode += this->_extrude_infill(std::get<1>(island.second));
-                    gcode += this->_extrude_perimeters(std::get<0>(island.second));
-                } else {
-                    gcode += this->_extrude_perimeters(std::get<0>(island.second));
-                    gcode += this->_extrude_infill(std::get<1>(island.second));
-                }
-            }
+            gcode += extrude_island_groups(pair.first, pair.second);
         }
         if (config.label_printed_objects) {
             gcode +=   "; stop printing object " + obj.model_object().name + " id:" + std::to_string(idx) + " copy "  + std::to_string(copy_idx) + "\n";
@@ -725,13 +744,13 @@ PrintGCode::process_layer(size_t idx, const Layer* layer, const Points& copies)
 
 // Extrude perimeters: Decide where to put seams (hide or align seams).
 std::string
-PrintGCode::_extrude_perimeters(std::map<size_t,ExtrusionEntityCollection> &by_region)
+PrintGCode::_extrude_perimeters(size_t extruder_id, std::map<size_t,std::vector<size_t>> &by_region)
 {
     std::string gcode = "";
     for(auto& pair : by_region) {
         this->_gcodegen.config.apply(this->_print.get_region(pair.first)->config);
-        for(auto& ee : pair.second){
-            gcode += this->_gcodegen.extrude(*ee, "perimeter");
+        for(auto node : pair.second){
+            gcode += this->_extrude_planned(extruder_id, pair.first, node, false, "perimeter");
         }
     }
     return gcode;
@@ -739,16 +758,48 @@ PrintGCode::_extrude_perimeters(std::map<size_t,ExtrusionEntityCollection> &by_r
 
 // Chain the paths hierarchically by a greedy algorithm to minimize a travel distance.
 std::string
-PrintGCode::_extrude_infill(std::map<size_t,ExtrusionEntityCollection> &by_region)
+PrintGCode::_extrude_infill(size_t extruder_id, std::map<size_t,std::vector<size_t>> &by_region)
 {
     std::string gcode = "";
+    std::vector< std::pair<size_t,bool> > order;
     for(auto& pair : by_region) {
         this->_gcodegen.config.apply(this->_print.get_region(pair.first)->config);
-        ExtrusionEntityCollection tmp;
-        pair.second.chained_path_from(this->_gcodegen.last_pos(),&tmp);
-        for(auto& ee : tmp){
-            gcode += this->_gcodegen.extrude(*ee, "infill");
+        order.clear();
+        for(auto node : pair.second) order.push_back(std::make_pair(node, false));
+        this->_extrusions.chained_path_from(this->_gcodegen.last_pos(), &order);
+        for(auto& item : order){
+            gcode += this->_extrude_planned(extruder_id, pair.first, item.first, item.second, "infill");
+        }
+    }
+    return gcode;
+}
+
+std::string
+PrintGCode::_extrude_planned(size_t extruder_id, size_t region_id, size_t node, bool reversed, const std::string &description)
+{
+    // the steps are kept from one layer to the next to reuse their buffers
+    if (this->_layer_plan_size == this->_layer_plan.size())
+        this->_layer_plan.emplace_back();
+    PlannedStep &step = this->_layer_plan[this->_layer_plan_size++];
+    step.extruder_id = extruder_id;
+    step.region_id = region_id;
+    this->_gcodegen.plan(this->_extrusions, node, reversed, description, -1, &step.extrusion);
+    return this->_gcodegen.extrude(step.extrusion);
+}
+
+std::string
+PrintGCode::_replay_plan(size_t extruder_id)
+{
+    std::string gcode = "";
+    size_t region_id = this->_print.regions.size();
+    for (size_t i = 0; i < this->_layer_plan_size; ++i) {
+        const PlannedStep &step = this->_layer_plan[i];
+        if (step.extruder_id != extruder_id) continue;
+        if (step.region_id != region_id) {
+            region_id = step.region_id;
+            this->_gcodegen.config.apply(this->_print.get_region(region_id)->config);
         }
+        gcode += this->_gcodegen.extrude(step.extrusion);
     }
     return gcode;
 }
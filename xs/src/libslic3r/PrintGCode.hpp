@@ -7,6 +7,7 @@
 #include "Geometry.hpp"
 #include "Flow.hpp"
 #include "ExtrusionEntity.hpp"
+#include "ExtrusionArena.hpp"
 #include "libslic3r.h"
 
 #include <string>
@@ -42,6 +43,10 @@ private:
 
     std::ostream& fh;
 
+    /// Flat copy of the perimeters and fills of the layer being processed,
+    /// its buffers are reused from one layer to the next.
+    ExtrusionArena _extrusions;
+
     Slic3r::CoolingBuffer _cooling_buffer;
     Slic3r::SpiralVase _spiral_vase;
 //    Slic3r::VibrationLimit _vibration_limit;
@@ -61,11 +66,28 @@ private:
     /// Utility function to print config options as gcode comments
     void _print_config(const ConfigBase& config);
 
+    /// An extrusion of the layer being processed and what it is printed with.
+    struct PlannedStep {
+        size_t extruder_id;
+        size_t region_id;
+        PlannedExtrusion extrusion;
+    };
+    /// Seams and order of the extrusions of the layer being processed. They are
+    /// decided while extruding its first copy and replayed, translated, on the other ones.
+    std::vector<PlannedStep> _layer_plan;
+    size_t _layer_plan_size {0};
+
     // Extrude perimeters: Decide where to put seams (hide or align seams).
-    std::string _extrude_perimeters(std::map<size_t,ExtrusionEntityCollection> &by_region);
+    std::string _extrude_perimeters(size_t extruder_id, std::map<size_t,std::vector<size_t>> &by_region);
 
     // Chain the paths hierarchically by a greedy algorithm to minimize a travel distance.
-    std::string _extrude_infill(std::map<size_t,ExtrusionEntityCollection> &by_region);
+    std::string _extrude_infill(size_t extruder_id, std::map<size_t,std::vector<size_t>> &by_region);
+
+    /// Plan an extrusion of this->_extrusions, extrude it and keep the plan for the next copies.
+    std::string _extrude_planned(size_t extruder_id, size_t region_id, size_t node, bool reversed, const std::string &description);
+
+    /// Extrude the steps of _layer_plan printed by an extruder.
+    std::string _replay_plan(size_t extruder_id);
 
     /// regular expression to match heater gcodes
     std::regex bed_temp_regex { std::regex("M(?:190|140)", std::regex_constants::icase)};
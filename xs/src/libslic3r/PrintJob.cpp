@@ -0,0 +1,145 @@
+#include "PrintJob.hpp"
+#include <chrono>
+
+namespace Slic3r {
+
+PrintJob::~PrintJob()
+{
+    this->cancel();
+}
+
+void
+PrintJob::start(const std::string &output_file)
+{
+    this->cancel();
+    this->_output_file = output_file;
+    {
+        boost::lock_guard<boost::mutex> l(this->_mutex);
+        this->_status = pjRunning;
+        this->_error.clear();
+        this->_timings.clear();
+    }
+    this->_print->cancel_token.reset();
+    this->_print->status_cb = this->status_cb;
+    this->_thread = boost::thread(&PrintJob::_run, this);
+}
+
+void
+PrintJob::cancel()
+{
+    if (!this->_thread.joinable()) return;
+    this->_print->cancel_token.cancel();
+    this->_thread.join();
+}
+
+PrintJob::Status
+PrintJob::wait()
+{
+    if (this->_thread.joinable())
+        this->_thread.join();
+    return this->status();
+}
+
+bool
+PrintJob::apply_config(const DynamicPrintConfig &config)
+{
+    const bool running = this->status() == pjRunning;
+    this->cancel();
+    const bool invalidated = this->_print->apply_config(config);
+    if (running || (invalidated && this->status() == pjFinished))
+        this->start(this->_output_file);
+    return invalidated;
+}
+
+PrintJob::Status
+PrintJob::status() const
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    return this->_status;
+}
+
+std::string
+PrintJob::error() const
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    return this->_error;
+}
+
+std::vector<PrintJob::StepTiming>
+PrintJob::timings() const
+{
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    return this->_timings;
+}
+
+void
+PrintJob::_set_status(Status status, const std::string &error)
+{
+    this->_print->status_cb = nullptr;
+    boost::lock_guard<boost::mutex> l(this->_mutex);
+    this->_status = status;
+    this->_error = error;
+}
+
+void
+PrintJob::_step(const std::string &name, const PrintObject* object, bool done, std::function<void()> step)
+{
+    this->_print->throw_if_canceled();
+    const auto t0 = std::chrono::steady_clock::now();
+    step();
+    const StepTiming timing {
+        name, object,
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(),
+        done
+    };
+    {
+        boost::lock_guard<boost::mutex> l(this->_mutex);
+        this->_timings.push_back(timing);
+    }
+    if (this->step_cb != nullptr)
+        this->step_cb(timing);
+}
+
+void
+PrintJob::_run()
+{
+    Print &print = *this->_print;
+    try {
+        if (!this->_output_file.empty())
+            print.validate();
+        
+        // same order as Print::process()
+        for (PrintObject* object : print.objects)
+            this->_step("slice", object, object->state.is_done(posSlice),
+                [object]() { object->slice(); });
+        for (PrintObject* object : print.objects)
+            this->_step("prepare_infill", object, object->state.is_done(posPrepareInfill),
+                [object]() { object->prepare_infill(); });
+        for (PrintObject* object : print.objects)
+            this->_step("infill", object, object->state.is_done(posInfill),
+                [object]() { object->infill(); });
+        for (PrintObject* object : print.objects)
+            this->_step("support_material", object, object->state.is_done(posSupportMaterial),
+                [object]() {
+                    object->generate_support_material();
+                    object->spill_layers();
+                });
+        this->_step("skirt", nullptr, print.state.is_done(psSkirt),
+            [&print]() { print.make_skirt(); });
+        this->_step("brim", nullptr, print.state.is_done(psBrim),
+            [&print]() { print.make_brim(); });
+
+        if (!this->_output_file.empty())
+            this->_step("export_gcode", nullptr, false,
+                [this, &print]() { print.export_gcode(this->_output_file); });
+        this->_set_status(pjFinished);
+    } catch (CanceledException &) {
+        print.discard_unfinished_steps();
+        this->_set_status(pjCanceled);
+    } catch (std::exception &e) {
+        print.discard_unfinished_steps();
+        this->_set_status(pjFailed, e.what());
+    }
+}
+
+}
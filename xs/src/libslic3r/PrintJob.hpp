@@ -0,0 +1,77 @@
+#ifndef slic3r_PrintJob_hpp_
+#define slic3r_PrintJob_hpp_
+
+#include "libslic3r.h"
+#include "Print.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+
+namespace Slic3r {
+
+/// Runs the steps of a Print (and optionally its G-code export) on a worker thread.
+/// The job can be canceled at any time: the steps check the cancellation token of
+/// the Print between layers, so cancel() returns after at most one layer of work.
+/// The steps which were finished stay valid, so running the job again, after
+/// cancel() or after a configuration change invalidated some of them, only does
+/// the remaining ones.
+/// The Print must not be touched by the caller while the job is running.
+class PrintJob
+{
+    public:
+    enum Status { pjIdle, pjRunning, pjFinished, pjCanceled, pjFailed };
+
+    /// Time spent on a step of the print, for a single object or for the whole print.
+    struct StepTiming {
+        std::string step;
+        const PrintObject* object;  ///< nullptr for the steps of the whole print
+        double seconds;
+        bool reused;                ///< the step was still valid and did not run
+    };
+
+    /// Progress of the steps, forwarded from Print::status_cb.
+    /// Both callbacks are called from the worker thread.
+    std::function<void(int, const std::string&)> status_cb {nullptr};
+    /// Called at the end of every step.
+    std::function<void(const StepTiming&)> step_cb {nullptr};
+
+    PrintJob(Print* print) : _print(print), _status(pjIdle) {};
+    ~PrintJob();
+
+    /// Start processing the print. The G-code is exported to output_file
+    /// unless it is empty. A job already running is canceled first.
+    void start(const std::string &output_file = "");
+    /// Stop the job and wait for the worker to finish.
+    void cancel();
+    /// Wait for the job to end.
+    Status wait();
+    /// Apply a new configuration to the print. A running job is canceled and
+    /// started again, a finished one is started again if the configuration
+    /// invalidated some of its steps.
+    /// Returns whether any step was invalidated.
+    bool apply_config(const DynamicPrintConfig &config);
+
+    Status status() const;
+    /// Message of the exception which made the job fail.
+    std::string error() const;
+    /// Timings of the steps of the last run, in the order they ended.
+    std::vector<StepTiming> timings() const;
+
+    private:
+    Print* _print;
+    std::string _output_file;
+    boost::thread _thread;
+    mutable boost::mutex _mutex;
+    Status _status;
+    std::string _error;
+    std::vector<StepTiming> _timings;
+
+    void _run();
+    void _step(const std::string &name, const PrintObject* object, bool done, std::function<void()> step);
+    void _set_status(Status status, const std::string &error = "");
+};
+
+}
+
+#endif
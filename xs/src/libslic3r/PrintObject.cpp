@@ -173,6 +173,7 @@ void
 PrintObject::delete_layer(int idx)
 {
     LayerPtrs::iterator i = this->layers.begin() + idx;
+    this->layer_store.forget(*i);
     delete *i;
     this->layers.erase(i);
 }
@@ -202,6 +203,7 @@ void
 PrintObject::delete_support_layer(int idx)
 {
     SupportLayerPtrs::iterator i = this->support_layers.begin() + idx;
+    this->layer_store.forget(*i);
     delete *i;
     this->support_layers.erase(i);
 }
@@ -282,6 +284,9 @@ PrintObject::invalidate_step(PrintObjectStep step)
 {
     bool invalidated = this->state.invalidate(step);
     
+    // the steps to run again need the layers in memory
+    if (invalidated) this->layer_store.restore();
+    
     // propagate to dependent steps
     if (step == posPerimeters) {
         invalidated |= this->invalidate_step(posPrepareInfill);
@@ -337,16 +342,35 @@ PrintObject::detect_surfaces_type()
 {
     if (this->state.is_done(posDetectSurfaces)) return;
     this->state.set_started(posDetectSurfaces);
+    ProfilerTimer timer("detect_surfaces_type");
     
     // prerequisites
     this->slice();
     
+    // Each layer is clipped against both of its neighbors: convert the islands
+    // to Clipper paths once per layer instead of twice per region.
+    parallelize<Layer*>(
+        std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
+        [this](Layer* layer) {
+            this->_print->throw_if_canceled();
+            layer->_slices_islands.assign(layer->slices.expolygons);
+        },
+        this->_print->config.threads.value
+    );
+    
     parallelize<Layer*>(
         std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::detect_surfaces_type, _1),
+        [this](Layer* layer) {
+            this->_print->throw_if_canceled();
+            ProfilerTimer timer("detect_surfaces_type", "layer", layer->id());
+            layer->detect_surfaces_type();
+        },
         this->_print->config.threads.value
     );
     
+    for (Layer* layer : this->layers)
+        layer->_slices_islands.clear();
+    
     this->typed_slices = true;
     this->state.set_done(posDetectSurfaces);
 }
@@ -356,7 +380,11 @@ PrintObject::process_external_surfaces()
 {
     parallelize<Layer*>(
         std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::process_external_surfaces, _1),
+        [this](Layer* layer) {
+            this->_print->throw_if_canceled();
+            ProfilerTimer timer("process_external_surfaces", "layer", layer->id());
+            layer->process_external_surfaces();
+        },
         this->_print->config.threads.value
     );
 }
@@ -804,6 +832,7 @@ void PrintObject::_slice()
         }
     }
 
+    this->_print->throw_if_canceled();
     if (this->print()->regions.size() == 1) {
         // Optimized for a single region. Slice the single non-modifier mesh.
         std::vector<ExPolygons> expolygons_by_layer = this->_slice_region(0, slice_zs, false);
@@ -812,12 +841,14 @@ void PrintObject::_slice()
     } else {
         // Slice all non-modifier volumes.
         for (size_t region_id = 0; region_id < this->print()->regions.size(); ++ region_id) {
+            this->_print->throw_if_canceled();
             std::vector<ExPolygons> expolygons_by_layer = this->_slice_region(region_id, slice_zs, false);
             for (size_t layer_id = 0; layer_id < expolygons_by_layer.size(); ++ layer_id)
                 this->layers[layer_id]->regions[region_id]->slices.append(std::move(expolygons_by_layer[layer_id]), stInternal);
         }
         // Slice all modifier volumes.
         for (size_t region_id = 0; region_id < this->print()->regions.size(); ++ region_id) {
+            this->_print->throw_if_canceled();
             std::vector<ExPolygons> expolygons_by_layer = this->_slice_region(region_id, slice_zs, true);
             // loop through the other regions and 'steal' the slices belonging to this one
             for (size_t other_region_id = 0; other_region_id < this->print()->regions.size(); ++ other_region_id) {
@@ -860,6 +891,7 @@ void PrintObject::_slice()
     // Apply size compensation and perform clipping of multi-part objects.
     const coord_t xy_size_compensation = scale_(this->config.xy_size_compensation.value);
     for (Layer* layer : this->layers) {
+        this->_print->throw_if_canceled();
         if (abs(xy_size_compensation) > 0) {
             if (layer->regions.size() == 1) {
                 // Single region, growing or shrinking.
@@ -965,6 +997,7 @@ PrintObject::slice()
 {
     if (this->state.is_done(posSlice)) return;
     this->state.set_started(posSlice);
+    ProfilerTimer timer("slice");
     if (_print->status_cb != nullptr) {
         _print->status_cb(10, "Processing triangulated mesh");
     }
@@ -1063,6 +1096,7 @@ PrintObject::make_perimeters()
         this->invalidate_step(posSlice);
     }
     this->state.set_started(posPerimeters);
+    ProfilerTimer timer("make_perimeters");
 
     // prerequisites
     this->slice();
@@ -1096,6 +1130,7 @@ PrintObject::make_perimeters()
             || this->layer_count() < 2) continue;
         
         for (size_t i = 0; i <= (this->layer_count()-2); ++i) {
+            this->_print->throw_if_canceled();
             LayerRegion &layerm                     = *this->get_layer(i)->get_region(region_id);
             const LayerRegion &upper_layerm         = *this->get_layer(i+1)->get_region(region_id);
             
@@ -1133,7 +1168,8 @@ PrintObject::make_perimeters()
                     );
                     
                     // check whether a portion of the upper slices falls inside the critical area
-                    const Polylines intersection = intersection_pl(
+                    // (most upper islands are nowhere near it and get culled by their bounding box)
+                    const Polylines intersection = intersection_pl_partitioned(
                         upper_layerm_polygons,
                         critical_area
                     );
@@ -1171,7 +1207,11 @@ PrintObject::make_perimeters()
     
     parallelize<Layer*>(
         std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::make_perimeters, _1),
+        [this](Layer* layer) {
+            this->_print->throw_if_canceled();
+            ProfilerTimer timer("make_perimeters", "layer", layer->id());
+            layer->make_perimeters();
+        },
         this->_print->config.threads.value
     );
     
@@ -1190,13 +1230,23 @@ PrintObject::infill()
 {
     if (this->state.is_done(posInfill)) return;
     this->state.set_started(posInfill);
+    ProfilerTimer timer("infill");
     
     // prerequisites
     this->prepare_infill();
     
+    // nothing but the G-code export reads the fills, so they can go to disk
+    // as soon as they are made
+    const bool spill = this->_print->config.layer_memory_window.value > 0;
+    this->layer_store.window = this->_print->config.layer_memory_window.value;
     parallelize<Layer*>(
         std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::make_fills, _1),
+        [this, spill](Layer* layer) {
+            this->_print->throw_if_canceled();
+            ProfilerTimer timer("make_fills", "layer", layer->id());
+            layer->make_fills();
+            if (spill) this->layer_store.spill(layer, LayerStore::lsfFills);
+        },
         this->_print->config.threads.value
     );
     
@@ -1207,6 +1257,17 @@ PrintObject::infill()
     this->state.set_done(posInfill);
 }
 
+void
+PrintObject::spill_layers()
+{
+    if (this->_print->config.layer_memory_window.value <= 0) return;
+    this->layer_store.window = this->_print->config.layer_memory_window.value;
+    for (Layer* layer : this->layers)
+        this->layer_store.spill(layer);
+    for (SupportLayer* layer : this->support_layers)
+        this->layer_store.spill(layer);
+}
+
 void
 PrintObject::prepare_infill()
 {
@@ -1220,6 +1281,7 @@ PrintObject::prepare_infill()
     this->make_perimeters();
 
     this->state.set_started(posPrepareInfill);
+    ProfilerTimer timer("prepare_infill");
 
     // prerequisites
     this->detect_surfaces_type();
@@ -1228,9 +1290,11 @@ PrintObject::prepare_infill()
         this->_print->status_cb(30, "Preparing infill");
     
     // decide what surfaces are to be filled
-    for (auto& layer : this->layers)
+    for (auto& layer : this->layers) {
+        this->_print->throw_if_canceled();
         for (auto& layerm : layer->regions)
             layerm->prepare_fill_surfaces();
+    }
 
     // this will detect bridges and reverse bridges
     // and rearrange top/bottom/internal surfaces
@@ -1441,6 +1505,7 @@ PrintObject::generate_support_material()
     if (this->state.is_done(posSupportMaterial)) { return; }
 
     this->state.set_started(posSupportMaterial); 
+    ProfilerTimer timer("generate_support_material");
 
     this->clear_support_layers();
 
@@ -1454,6 +1519,7 @@ PrintObject::generate_support_material()
     }
     if (_print->status_cb != nullptr)
         _print->status_cb(85, "Generating support material");
+    this->_print->throw_if_canceled();
 
     this->_support_material()->generate(this);
 
@@ -1476,6 +1542,7 @@ PrintObject::discover_horizontal_shells()
     
     for (size_t region_id = 0U; region_id < _print->regions.size(); ++region_id) {
         for (size_t i = 0; i < this->layer_count(); ++i) {
+            this->_print->throw_if_canceled();
             auto* layerm = this->get_layer(i)->get_region(region_id);
             const auto& region_config = layerm->region()->config;
 
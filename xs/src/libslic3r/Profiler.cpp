@@ -0,0 +1,167 @@
+#include "Profiler.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <boost/thread.hpp>
+
+namespace Slic3r {
+
+std::atomic<bool> Profiler::_enabled(false);
+std::atomic<uint64_t> Profiler::_counters[Profiler::pcCount];
+
+namespace {
+
+/// What the Profiler recorded since it was enabled.
+struct ProfilerData {
+    boost::mutex mutex;
+    std::chrono::steady_clock::time_point epoch;
+    std::vector<Profiler::Span> spans;
+    std::map<boost::thread::id, unsigned int> threads;
+    double parallel_busy = 0, parallel_capacity = 0;
+};
+
+ProfilerData& profiler_data()
+{
+    static ProfilerData data;
+    return data;
+}
+
+const char* counter_name(Profiler::Counter counter)
+{
+    switch (counter) {
+        case Profiler::pcClipperBoolean: return "clipper_boolean";
+        case Profiler::pcClipperOffset:  return "clipper_offset";
+        case Profiler::pcAllocations:    return "allocations";
+        case Profiler::pcAllocatedBytes: return "allocated_bytes";
+        default: return "";
+    }
+}
+
+}
+
+void
+Profiler::enable()
+{
+    ProfilerData &data = profiler_data();
+    {
+        boost::lock_guard<boost::mutex> l(data.mutex);
+        data.epoch = std::chrono::steady_clock::now();
+        data.spans.clear();
+        data.threads.clear();
+        data.parallel_busy = data.parallel_capacity = 0;
+    }
+    for (std::atomic<uint64_t> &counter : _counters)
+        counter = 0;
+    _enabled = true;
+}
+
+void
+Profiler::disable()
+{
+    _enabled = false;
+}
+
+void
+Profiler::record(const char* name, const char* category, long layer,
+    std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    ProfilerData &data = profiler_data();
+    boost::lock_guard<boost::mutex> l(data.mutex);
+    // threads are numbered in order of appearance, 0 being the first one to record a span
+    const unsigned int thread = data.threads.emplace(boost::this_thread::get_id(), data.threads.size()).first->second;
+    data.spans.push_back(Span {
+        name, category, layer, thread,
+        std::chrono::duration_cast<std::chrono::microseconds>(start - data.epoch).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+    });
+}
+
+void
+Profiler::record_parallel(double wall_time, double busy_time, unsigned int workers)
+{
+    ProfilerData &data = profiler_data();
+    boost::lock_guard<boost::mutex> l(data.mutex);
+    data.parallel_busy     += busy_time;
+    data.parallel_capacity += wall_time * workers;
+}
+
+std::vector<Profiler::Span>
+Profiler::spans()
+{
+    ProfilerData &data = profiler_data();
+    boost::lock_guard<boost::mutex> l(data.mutex);
+    return data.spans;
+}
+
+double
+Profiler::thread_utilisation()
+{
+    ProfilerData &data = profiler_data();
+    boost::lock_guard<boost::mutex> l(data.mutex);
+    return data.parallel_capacity > 0 ? data.parallel_busy / data.parallel_capacity : 0;
+}
+
+void
+Profiler::report()
+{
+    // total time and number of spans by category and name, in order of first appearance
+    struct Total { std::string name; size_t count; int64_t duration; };
+    std::vector<Total> totals;
+    for (const Span &span : Profiler::spans()) {
+        const std::string name = std::string(span.category) + "/" + span.name;
+        auto it = std::find_if(totals.begin(), totals.end(), [&name](const Total &t) { return t.name == name; });
+        if (it == totals.end()) {
+            totals.push_back(Total { name, 1, span.duration });
+        } else {
+            ++it->count;
+            it->duration += span.duration;
+        }
+    }
+
+    for (const Total &total : totals)
+        Log::info("Profiler") << std::left << std::setw(40) << total.name
+            << std::right << std::fixed << std::setprecision(3) << std::setw(10) << total.duration / 1000. << " ms"
+            << std::setw(8) << total.count << " calls" << std::endl;
+    for (int counter = 0; counter < pcCount; ++counter)
+        Log::info("Profiler") << std::left << std::setw(40) << counter_name(Counter(counter))
+            << std::right << std::setw(10) << Profiler::counter(Counter(counter)) << std::endl;
+    Log::info("Profiler") << std::left << std::setw(40) << "thread_utilisation"
+        << std::right << std::fixed << std::setprecision(1) << std::setw(10)
+        << 100. * Profiler::thread_utilisation() << " %" << std::endl;
+}
+
+void
+Profiler::write_chrome_trace(std::ostream &out)
+{
+    // only complete ("X") events: Chrome nests them by time on each thread
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const Span &span : Profiler::spans()) {
+        out << (first ? "\n" : ",\n")
+            << "{\"name\":\"" << span.name << "\",\"cat\":\"" << span.category << "\",\"ph\":\"X\""
+            << ",\"ts\":" << span.start << ",\"dur\":" << span.duration
+            << ",\"pid\":1,\"tid\":" << span.thread;
+        if (span.layer >= 0)
+            out << ",\"args\":{\"layer\":" << span.layer << "}";
+        out << "}";
+        first = false;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{";
+    for (int counter = 0; counter < pcCount; ++counter)
+        out << "\"" << counter_name(Counter(counter)) << "\":" << Profiler::counter(Counter(counter)) << ",";
+    out << "\"thread_utilisation\":" << Profiler::thread_utilisation() << "}}\n";
+}
+
+void
+Profiler::write_chrome_trace(const std::string &filename)
+{
+    std::ofstream out(filename);
+    if (!out)
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    Profiler::write_chrome_trace(out);
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef slic3r_Profiler_hpp_
+#define slic3r_Profiler_hpp_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+/// Built-in instrumentation of the slicing pipeline.
+/// Nothing is recorded until enable() is called, so the timers and counters
+/// spread through the code only cost the test of an atomic flag otherwise.
+/// Records timed spans (the PrintObject steps and their per-layer work), event
+/// counters (Clipper operations, allocations) and how busy the parallelize()
+/// workers were, and reports them through Log or as a Chrome trace
+/// (chrome://tracing or https://ui.perfetto.dev).
+class Profiler
+{
+    public:
+    enum Counter {
+        pcClipperBoolean,   ///< boolean operations run by ClipperUtils (unions included)
+        pcClipperOffset,    ///< offsets run by ClipperUtils
+        pcAllocations,      ///< calls to operator new, see SLIC3R_PROFILE_ALLOCATIONS
+        pcAllocatedBytes,
+        pcCount
+    };
+
+    /// A timed section of code. Times are in microseconds since enable().
+    struct Span {
+        const char* name;
+        const char* category;
+        long layer;             ///< id of the layer processed, -1 for a whole step
+        unsigned int thread;    ///< index of the thread, in order of appearance
+        int64_t start, duration;
+    };
+
+    /// Start recording, dropping what was recorded before.
+    static void enable();
+    /// Stop recording, keeping what was recorded.
+    static void disable();
+    static bool enabled() { return _enabled.load(std::memory_order_relaxed); };
+
+    static void count(Counter counter, uint64_t n = 1) {
+        if (enabled()) _counters[counter].fetch_add(n, std::memory_order_relaxed);
+    };
+    static uint64_t counter(Counter counter) { return _counters[counter].load(); };
+    static void record(const char* name, const char* category, long layer,
+        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+    /// Record a parallelize() call which kept `workers` threads for wall_time
+    /// seconds, of which they spent busy_time (summed over all of them) running items.
+    static void record_parallel(double wall_time, double busy_time, unsigned int workers);
+
+    static std::vector<Span> spans();
+    /// Share of the time the parallelize() workers spent running items, 0 to 1.
+    static double thread_utilisation();
+
+    /// Log the total time of every span name, the counters and the thread utilisation.
+    static void report();
+    static void write_chrome_trace(std::ostream &out);
+    static void write_chrome_trace(const std::string &filename);
+
+    private:
+    static std::atomic<bool> _enabled;
+    static std::atomic<uint64_t> _counters[pcCount];
+};
+
+/// Records a Profiler span from its construction to its destruction.
+class ProfilerTimer
+{
+    public:
+    ProfilerTimer(const char* name, const char* category = "step", long layer = -1)
+        : name(name), category(category), layer(layer), active(Profiler::enabled())
+    {
+        if (this->active) this->start = std::chrono::steady_clock::now();
+    };
+    ~ProfilerTimer() {
+        if (this->active)
+            Profiler::record(this->name, this->category, this->layer, this->start, std::chrono::steady_clock::now());
+    };
+
+    private:
+    const char* name;
+    const char* category;
+    long layer;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+}
+
+#endif
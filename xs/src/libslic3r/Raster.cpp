@@ -0,0 +1,119 @@
+#include "Raster.hpp"
+#include "Zip/ZipArchive.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Slic3r {
+
+Raster::Raster(size_t width, size_t height, const Pointf &origin, double pixel_size, unsigned int samples)
+    : width(width), height(height), pixels(width * height, 0),
+      origin(origin), pixel_size(pixel_size), samples(std::max(samples, 1u))
+{}
+
+void
+Raster::_add_edges(const Polygon &polygon, std::vector<Edge>* edges) const
+{
+    const Points &pp = polygon.points;
+    for (size_t i = 0; i < pp.size(); ++i) {
+        const Point &a = pp[i];
+        const Point &b = pp[(i + 1) % pp.size()];
+        if (a.y == b.y) continue;  // horizontal edges never cross a scanline
+
+        // flip Y so that the first row is the top one
+        Edge edge;
+        edge.x0 = (unscale(a.x) - this->origin.x) / this->pixel_size;
+        edge.y0 = this->height - (unscale(a.y) - this->origin.y) / this->pixel_size;
+        edge.x1 = (unscale(b.x) - this->origin.x) / this->pixel_size;
+        edge.y1 = this->height - (unscale(b.y) - this->origin.y) / this->pixel_size;
+        if (edge.y0 > edge.y1) {
+            std::swap(edge.x0, edge.x1);
+            std::swap(edge.y0, edge.y1);
+        }
+        edges->push_back(edge);
+    }
+}
+
+void
+Raster::draw(const ExPolygons &expolygons)
+{
+    std::vector<Edge> edges;
+    for (const ExPolygon &expolygon : expolygons) {
+        this->_add_edges(expolygon.contour, &edges);
+        for (const Polygon &hole : expolygon.holes)
+            this->_add_edges(hole, &edges);
+    }
+    if (edges.empty()) return;
+    std::sort(edges.begin(), edges.end(), [](const Edge &e1, const Edge &e2) { return e1.y0 < e2.y0; });
+
+    double y_max = 0;
+    for (const Edge &edge : edges) y_max = std::max(y_max, edge.y1);
+    const size_t first_row = size_t(std::max(0., std::floor(edges.front().y0)));
+    const size_t last_row  = size_t(std::max(0., std::min(double(this->height), std::ceil(y_max))));
+
+    // coverage of each pixel of the current row, in pixels times scanlines
+    std::vector<float> coverage(this->width, 0.f);
+    std::vector<const Edge*> active;
+    std::vector<double> crossings;
+    size_t next_edge = 0;
+
+    for (size_t row = first_row; row < last_row; ++row) {
+        std::fill(coverage.begin(), coverage.end(), 0.f);
+        bool covered = false;
+
+        for (unsigned int s = 0; s < this->samples; ++s) {
+            const double y = row + (s + 0.5) / this->samples;
+
+            // update the active edge list: drop the edges ending above the scanline,
+            // add the ones starting above it
+            active.erase(std::remove_if(active.begin(), active.end(),
+                [y](const Edge* edge) { return edge->y1 <= y; }), active.end());
+            for (; next_edge < edges.size() && edges[next_edge].y0 <= y; ++next_edge)
+                if (edges[next_edge].y1 > y) active.push_back(&edges[next_edge]);
+
+            crossings.clear();
+            for (const Edge* edge : active)
+                crossings.push_back(edge->x_at(y));
+            std::sort(crossings.begin(), crossings.end());
+
+            // even-odd rule: holes are oriented the other way but need no special care
+            for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+                const double x0 = std::max(crossings[i], 0.);
+                const double x1 = std::min(crossings[i+1], double(this->width));
+                if (x1 <= x0) continue;
+                covered = true;
+                const size_t i0 = size_t(x0);
+                const size_t i1 = size_t(x1);
+                if (i0 == i1) {
+                    coverage[i0] += float(x1 - x0);
+                    continue;
+                }
+                coverage[i0] += float(i0 + 1 - x0);
+                for (size_t px = i0 + 1; px < i1; ++px) coverage[px] += 1.f;
+                if (i1 < this->width) coverage[i1] += float(x1 - i1);
+            }
+        }
+        if (!covered) continue;
+
+        uint8_t* pixel = &this->pixels[row * this->width];
+        for (size_t px = 0; px < this->width; ++px, ++pixel) {
+            const int value = std::min(255, int(std::lround(255. * coverage[px] / this->samples)));
+            *pixel = std::max<uint8_t>(*pixel, uint8_t(value));
+        }
+    }
+}
+
+std::string
+Raster::png() const
+{
+    size_t size = 0;
+    void* data = tdefl_write_image_to_png_file_in_memory_ex(
+        this->pixels.data(), int(this->width), int(this->height), 1, &size, MZ_DEFAULT_LEVEL, MZ_FALSE);
+    if (data == nullptr)
+        throw std::runtime_error("Failed to encode the PNG image");
+    const std::string png(static_cast<const char*>(data), size);
+    mz_free(data);
+    return png;
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef slic3r_Raster_hpp_
+#define slic3r_Raster_hpp_
+
+#include "libslic3r.h"
+#include "ExPolygon.hpp"
+#include "Point.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+/// An 8 bit grayscale image to draw filled shapes into.
+/// Shapes are filled with a scanline sweep. Each row of pixels is swept along
+/// `samples` scanlines and the horizontal coverage of every span is measured
+/// exactly, so the edges are anti-aliased; samples = 1 gives hard edges.
+/// The image is oriented like the SVG export: X grows to the right and Y
+/// grows upwards, the first row of pixels being the top one.
+class Raster
+{
+    public:
+    size_t width, height;
+    /// Pixel values, row by row starting from the top one.
+    std::vector<uint8_t> pixels;
+
+    /// \param origin       unscaled coordinates of the bottom left corner of the image
+    /// \param pixel_size   size of a pixel, in mm
+    /// \param samples      number of scanlines per row of pixels
+    Raster(size_t width, size_t height, const Pointf &origin, double pixel_size, unsigned int samples = 4);
+
+    /// Fill a set of non overlapping shapes (as returned by union_ex()).
+    /// Shapes drawn in separate calls may overlap: each pixel keeps the
+    /// highest coverage.
+    void draw(const ExPolygons &expolygons);
+    void draw(const ExPolygon &expolygon) { this->draw(ExPolygons(1, expolygon)); };
+
+    /// Value of a pixel, 0 (empty) to 255 (fully covered).
+    uint8_t at(size_t x, size_t y) const { return this->pixels[y * this->width + x]; };
+
+    /// Encode the image as a PNG file in memory.
+    std::string png() const;
+
+    private:
+    Pointf origin;
+    double pixel_size;
+    unsigned int samples;
+
+    /// An edge of a polygon, in pixel coordinates, with y0 < y1.
+    struct Edge {
+        double x0, y0, x1, y1;
+        double x_at(double y) const { return this->x0 + (this->x1 - this->x0) * (y - this->y0) / (this->y1 - this->y0); };
+    };
+    void _add_edges(const Polygon &polygon, std::vector<Edge>* edges) const;
+};
+
+}
+
+#endif
@@ -3,10 +3,17 @@
 #include "ExtrusionEntity.hpp"
 #include "Fill/Fill.hpp"
 #include "Geometry.hpp"
+#include "Raster.hpp"
 #include "Surface.hpp"
+#include "Zip/ZipArchive.hpp"
 #include <iostream>
+#include <algorithm>
+#include <iomanip>
 #include <complex>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <stdexcept>
 
 namespace Slic3r {
 
@@ -74,6 +81,7 @@ SLAPrint::slice()
             boost::bind(&SLAPrint::_infill_layer, this, _1, fill.get()),
             this->config.threads.value
         );
+        this->fill_patterns.clear();
     }
     
     // generate support material
@@ -82,9 +90,20 @@ SLAPrint::slice()
     if (this->config.support_material) {
         // flatten and merge all the overhangs
         {
+            std::vector<Polygons> layer_overhangs(this->layers.size());
+            parallelize<size_t>(
+                1,
+                this->layers.size()-1,
+                [this, &layer_overhangs](size_t i) {
+                    const Layer &layer = this->layers[i];
+                    const Layer &below = this->layers[i-1];
+                    layer_overhangs[i] = diff(layer.slices, below.slices);
+                },
+                this->config.threads.value
+            );
             Polygons pp;
-            for (std::vector<Layer>::const_iterator it = this->layers.begin()+1; it != this->layers.end(); ++it)
-                pp += diff(it->slices, (it - 1)->slices);
+            for (const Polygons &layer_pp : layer_overhangs)
+                append_to(pp, layer_pp);
             overhangs = union_ex(pp);
         }
         
@@ -108,34 +127,7 @@ SLAPrint::slice()
             }
         }
         
-        // for each pillar, check which layers it applies to
-        for (Points::const_iterator p = pillars_pos.begin(); p != pillars_pos.end(); ++p) {
-            SupportPillar pillar(*p);
-            bool object_hit = false;
-            
-            // check layers top-down
-            for (int i = this->layers.size()-1; i >= 0; --i) {
-                // check whether point is void in this layer
-                if (!this->layers[i].slices.contains(*p)) {
-                    // no slice contains the point, so it's in the void
-                    if (pillar.top_layer > 0) {
-                        // we have a pillar, so extend it
-                        pillar.bottom_layer = i + this->config.raft_layers;
-                    } else if (object_hit) {
-                        // we don't have a pillar and we're below the object, so create one
-                        pillar.top_layer = i + this->config.raft_layers;
-                    }
-                } else {
-                    if (pillar.top_layer > 0) {
-                        // we have a pillar which is not needed anymore, so store it and initialize a new potential pillar
-                        this->sm_pillars.push_back(pillar);
-                        pillar = SupportPillar(*p);
-                    }
-                    object_hit = true;
-                }
-            }
-            if (pillar.top_layer > 0) this->sm_pillars.push_back(pillar);
-        }
+        this->_generate_pillars(pillars_pos);
     }
     
     // generate a solid raft if requested
@@ -195,10 +187,20 @@ SLAPrint::_infill_layer(size_t i, const Fill* _fill)
         ExtrusionPath templ(erInternalInfill);
 
         const ExPolygons internal_ex = intersection_ex(infill, internal);
-        for (ExPolygons::const_iterator it = internal_ex.begin(); it != internal_ex.end(); ++it) {
-            Polylines polylines = fill->fill_surface(Surface(stInternal, *it));
-            templ.width = fill->spacing(); // fill->spacing doesn't have anything defined until after fill_surface
-            layer.infill.append(polylines, templ);
+        if (fill->can_clip()) {
+            // clip the pattern shared with the other layers, with the same inset
+            // as Fill::fill_surface()
+            const FillPattern &pattern = this->_fill_pattern(*fill);
+            templ.width = pattern.spacing;
+            const ExPolygons clip = offset_ex(internal_ex, -scale_(fill->min_spacing)/2);
+            for (ExPolygons::const_iterator it = clip.begin(); it != clip.end(); ++it)
+                layer.infill.append(pattern.clip(*it), templ);
+        } else {
+            for (ExPolygons::const_iterator it = internal_ex.begin(); it != internal_ex.end(); ++it) {
+                Polylines polylines = fill->fill_surface(Surface(stInternal, *it));
+                templ.width = fill->spacing(); // fill->spacing doesn't have anything defined until after fill_surface
+                layer.infill.append(polylines, templ);
+            }
         }
     }
     
@@ -209,11 +211,226 @@ SLAPrint::_infill_layer(size_t i, const Fill* _fill)
     );
 }
 
+const SLAPrint::FillPattern&
+SLAPrint::_fill_pattern(const Fill &fill)
+{
+    const std::pair<float,float> key(fill.layer_angle(fill.layer_id), fill.density);
+    
+    // the other threads would need the same pattern anyway, so keep the lock
+    // while generating it
+    boost::lock_guard<boost::mutex> l(this->fill_patterns_mutex);
+    std::shared_ptr<const FillPattern> &pattern = this->fill_patterns[key];
+    if (!pattern) {
+        // fill the whole object, growing it so that the inset done by
+        // Fill::fill_surface() does not eat its border
+        std::unique_ptr<Fill> f(fill.clone());
+        f->dont_connect = true;
+        BoundingBox bbox = f->bounding_box;
+        bbox.offset(scale_(f->min_spacing));
+        const Polylines polylines = f->fill_surface(Surface(stInternal, ExPolygon(bbox.polygon())));
+        pattern.reset(new FillPattern(polylines, f->spacing()));
+    }
+    return *pattern;
+}
+
+SLAPrint::FillPattern::FillPattern(const Polylines &polylines, coordf_t spacing)
+    : polylines(polylines), spacing(spacing)
+{
+    this->bboxes.reserve(this->polylines.size());
+    for (const Polyline &polyline : this->polylines)
+        this->bboxes.push_back(polyline.bounding_box());
+}
+
+/// Uniform grid of cells over a bounding box, listing the segments crossing each cell.
+class SegmentGrid
+{
+    public:
+    SegmentGrid(const BoundingBox &bb, size_t segments) : bb(bb) {
+        // about one segment per cell
+        const size_t side = std::min<size_t>(std::max<size_t>(std::sqrt(double(segments)), 1), 64);
+        const Point size = bb.size();
+        this->cell_size = std::max<coord_t>(std::max(size.x, size.y) / side, 1);
+        this->columns   = size.x / this->cell_size + 1;
+        this->rows      = size.y / this->cell_size + 1;
+        this->cells.resize(this->columns * this->rows);
+    };
+    
+    void insert(const Line &line, size_t idx) {
+        this->for_each_cell(line, [this, idx](size_t cell) {
+            std::vector<size_t> &segments = this->cells[cell];
+            if (segments.empty() || segments.back() != idx) segments.push_back(idx);
+        });
+    };
+    
+    /// Call fn with the index of each cell crossed by the part of the line
+    /// within the grid, row by row.
+    template <class Fn> void for_each_cell(const Line &line, Fn fn) const {
+        const Point &a = line.a;
+        const Point &b = line.b;
+        const coord_t y_min = std::max(std::min(a.y, b.y), this->bb.min.y);
+        const coord_t y_max = std::min(std::max(a.y, b.y), this->bb.max.y);
+        if (y_min > y_max) return;
+        for (size_t row = this->_row(y_min); row <= this->_row(y_max); ++row) {
+            coordf_t x0 = std::min(a.x, b.x);
+            coordf_t x1 = std::max(a.x, b.x);
+            if (a.y != b.y) {
+                // X range of the part of the line within this row
+                const coordf_t band_min = std::max<coordf_t>(y_min, this->bb.min.y + coordf_t(row) * this->cell_size);
+                const coordf_t band_max = std::min<coordf_t>(y_max, this->bb.min.y + coordf_t(row + 1) * this->cell_size);
+                const coordf_t xa = a.x + (b.x - a.x) * (band_min - a.y) / coordf_t(b.y - a.y);
+                const coordf_t xb = a.x + (b.x - a.x) * (band_max - a.y) / coordf_t(b.y - a.y);
+                x0 = std::min(xa, xb);
+                x1 = std::max(xa, xb);
+            }
+            if (x1 < this->bb.min.x || x0 > this->bb.max.x) continue;
+            for (size_t column = this->_column(x0); column <= this->_column(x1); ++column)
+                fn(row * this->columns + column);
+        }
+    };
+    
+    const std::vector<size_t>& cell(size_t idx) const { return this->cells[idx]; };
+    
+    private:
+    BoundingBox bb;
+    coord_t cell_size;
+    size_t columns, rows;
+    std::vector< std::vector<size_t> > cells;
+    
+    size_t _row(coordf_t y) const {
+        return std::min<size_t>(std::max<coordf_t>(y - this->bb.min.y, 0) / this->cell_size, this->rows - 1);
+    };
+    size_t _column(coordf_t x) const {
+        return std::min<size_t>(std::max<coordf_t>(x - this->bb.min.x, 0) / this->cell_size, this->columns - 1);
+    };
+};
+
+Polylines
+SLAPrint::FillPattern::clip(const ExPolygon &expolygon) const
+{
+    const BoundingBox bbox = expolygon.contour.bounding_box();
+    const Lines edges = expolygon.lines();
+    SegmentGrid grid(bbox, edges.size());
+    for (size_t i = 0; i < edges.size(); ++i)
+        grid.insert(edges[i], i);
+    
+    Polylines out;
+    std::vector<size_t> visited(edges.size(), size_t(-1));
+    size_t stamp = 0;
+    std::vector<double> crossings;
+    for (size_t idx = 0; idx < this->polylines.size(); ++idx) {
+        if (!this->bboxes[idx].overlap(bbox)) continue;
+        
+        const Points &pp = this->polylines[idx].points;
+        bool inside = false;
+        for (size_t j = 0; j + 1 < pp.size(); ++j) {
+            const Point &a = pp[j];
+            const Point &b = pp[j+1];
+            const Line segment(a, b);
+            
+            // Parameters along the segment of its crossings with the edges.
+            // An edge is crossed when its ends lie on both sides of the segment,
+            // one of them possibly on it; the same rule applied to the segment
+            // counts a crossing at a vertex of the expolygon once.
+            ++stamp;
+            crossings.clear();
+            grid.for_each_cell(segment, [&](size_t cell) {
+                for (size_t e : grid.cell(cell)) {
+                    if (visited[e] == stamp) continue;
+                    visited[e] = stamp;
+                    const Point &p = edges[e].a;
+                    const Point &q = edges[e].b;
+                    const int64_t side_p = int64_t(b.x - a.x) * (p.y - a.y) - int64_t(b.y - a.y) * (p.x - a.x);
+                    const int64_t side_q = int64_t(b.x - a.x) * (q.y - a.y) - int64_t(b.y - a.y) * (q.x - a.x);
+                    if ((side_p > 0) == (side_q > 0)) continue;
+                    const int64_t side_a = int64_t(q.x - p.x) * (a.y - p.y) - int64_t(q.y - p.y) * (a.x - p.x);
+                    const int64_t side_b = int64_t(q.x - p.x) * (b.y - p.y) - int64_t(q.y - p.y) * (b.x - p.x);
+                    if ((side_a > 0) == (side_b > 0)) continue;
+                    crossings.push_back(double(side_a) / double(side_a - side_b));
+                }
+            });
+            std::sort(crossings.begin(), crossings.end());
+            
+            for (double t : crossings) {
+                const Point p(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+                if (inside) {
+                    out.back().points.push_back(p);
+                } else {
+                    out.push_back(Polyline());
+                    out.back().points.push_back(p);
+                }
+                inside = !inside;
+            }
+            if (inside) out.back().points.push_back(b);
+        }
+    }
+    
+    // drop what was left of the lines touching the expolygon at a single point
+    out.erase(std::remove_if(out.begin(), out.end(),
+        [](const Polyline &polyline) { return polyline.length() <= 0; }), out.end());
+    return out;
+}
+
+void
+SLAPrint::_generate_pillars(const Points &pillars_pos)
+{
+    if (pillars_pos.empty()) return;
+    
+    // bounding boxes of the islands of each layer, to skip the point in polygon
+    // tests for the islands far from a pillar
+    std::vector< std::vector<BoundingBox> > islands_bb(this->layers.size());
+    for (size_t i = 0; i < this->layers.size(); ++i)
+        for (const ExPolygon &expolygon : this->layers[i].slices.expolygons)
+            islands_bb[i].push_back(expolygon.contour.bounding_box());
+    
+    // for each pillar, check which layers it applies to, sweeping the layers
+    // top-down; pillars are independent, so they are swept in parallel
+    std::vector< std::vector<SupportPillar> > pillars(pillars_pos.size());
+    parallelize<size_t>(
+        0,
+        pillars_pos.size()-1,
+        [this, &pillars_pos, &islands_bb, &pillars](size_t k) {
+            const Point &p = pillars_pos[k];
+            SupportPillar pillar(p);
+            bool object_hit = false;
+            
+            for (int i = this->layers.size()-1; i >= 0; --i) {
+                // check whether point is void in this layer
+                const ExPolygons &islands = this->layers[i].slices.expolygons;
+                bool in_island = false;
+                for (size_t j = 0; j < islands.size() && !in_island; ++j)
+                    in_island = islands_bb[i][j].contains(p) && islands[j].contour.contains(p);
+                
+                if (!in_island) {
+                    // no slice contains the point, so it's in the void
+                    if (pillar.top_layer > 0) {
+                        // we have a pillar, so extend it
+                        pillar.bottom_layer = i + this->config.raft_layers;
+                    } else if (object_hit) {
+                        // we don't have a pillar and we're below the object, so create one
+                        pillar.top_layer = i + this->config.raft_layers;
+                    }
+                } else {
+                    if (pillar.top_layer > 0) {
+                        // we have a pillar which is not needed anymore, so store it and initialize a new potential pillar
+                        pillars[k].push_back(pillar);
+                        pillar = SupportPillar(p);
+                    }
+                    object_hit = true;
+                }
+            }
+            if (pillar.top_layer > 0) pillars[k].push_back(pillar);
+        },
+        this->config.threads.value
+    );
+    
+    for (const std::vector<SupportPillar> &position_pillars : pillars)
+        this->sm_pillars.insert(this->sm_pillars.end(), position_pillars.begin(), position_pillars.end());
+}
+
 void
 SLAPrint::write_svg(const std::string &outputfile) const
 {
     const Sizef3 size = this->bb.size();
-    const double support_material_radius = sm_pillars_radius();
     
     FILE* f = fopen(outputfile.c_str(), "w");
     fprintf(f,
@@ -284,11 +501,7 @@ SLAPrint::write_svg(const std::string &outputfile) const
             for (std::vector<SupportPillar>::const_iterator it = this->sm_pillars.begin(); it != this->sm_pillars.end(); ++it) {
                 if (!(it->top_layer >= i && it->bottom_layer <= i)) continue;
             
-                // generate a conic tip
-                float radius = fminf(
-                    support_material_radius,
-                    (it->top_layer - i + 1) * this->config.layer_height.value
-                );
+                const float radius = this->sm_pillar_radius(*it, i);
             
                 fprintf(f,"\t\t<circle cx=\"%f\" cy=\"%f\" r=\"%f\" stroke-width=\"0\" fill=\"white\" slic3r:type=\"support\" />\n",
                     unscale(it->x) - this->bb.min.x,
@@ -308,6 +521,87 @@ SLAPrint::write_svg(const std::string &outputfile) const
     fclose(f);
 }
 
+void
+SLAPrint::write_png(const std::string &outputfile) const
+{
+    const Sizef3 size = this->bb.size();
+    const double pixel_size = this->config.sla_pixel_size.value;
+    const size_t width  = std::max<size_t>(1, std::ceil(size.x / pixel_size));
+    const size_t height = std::max<size_t>(1, std::ceil(size.y / pixel_size));
+    const Pointf origin(this->bb.min.x, this->bb.min.y);
+    
+    ZipArchive zip(outputfile, 'W');
+    if (!zip.z_stats())
+        throw std::runtime_error("Cannot create " + outputfile);
+    
+    // Rasterize one batch of layers at a time, one layer per thread, and write
+    // the batch before starting the next one: no more than a batch of images is
+    // held in memory, and the archive is written in layer order.
+    const size_t batch_size = std::max(1, this->config.threads.value);
+    std::vector<std::string> images(batch_size);
+    for (size_t first = 0; first < this->layers.size(); first += batch_size) {
+        const size_t last = std::min(first + batch_size, this->layers.size()) - 1;
+        parallelize<size_t>(
+            first,
+            last,
+            [this, &images, first, width, height, &origin, pixel_size](size_t i) {
+                Raster raster(width, height, origin, pixel_size, this->config.sla_antialiasing.value);
+                raster.draw(this->_layer_shapes(i));
+                images[i - first] = raster.png();
+            },
+            this->config.threads.value
+        );
+        
+        for (size_t i = first; i <= last; ++i) {
+            std::ostringstream name;
+            name << "layer" << std::setw(5) << std::setfill('0') << i << ".png";
+            std::string &image = images[i - first];
+            // PNG data is already deflated
+            if (!zip.add_entry_from_memory(name.str(), image.data(), image.size(), MZ_NO_COMPRESSION))
+                throw std::runtime_error("Cannot write " + name.str() + " to " + outputfile);
+            std::string().swap(image);
+        }
+    }
+    
+    if (!zip.finalize())
+        throw std::runtime_error("Cannot write " + outputfile);
+}
+
+ExPolygons
+SLAPrint::_layer_shapes(size_t i) const
+{
+    const Layer &layer = this->layers[i];
+    
+    // collect everything which is exposed in this layer, as in write_svg()
+    Polygons pp;
+    if (layer.solid) {
+        pp = to_polygons(layer.slices.expolygons);
+    } else {
+        pp = to_polygons(layer.perimeters.expolygons);
+        append_to(pp, to_polygons(layer.solid_infill.expolygons));
+        for (const ExtrusionEntity* entity : layer.infill.entities)
+            append_to(pp, entity->grow());
+    }
+    
+    // don't print support material in raft layers
+    if (i >= (size_t)this->config.raft_layers) {
+        for (const SupportPillar &pillar : this->sm_pillars) {
+            if (!(pillar.top_layer >= i && pillar.bottom_layer <= i)) continue;
+            
+            const coord_t radius = scale_(this->sm_pillar_radius(pillar, i));
+            const size_t segments = 32;
+            Polygon circle;
+            for (size_t k = 0; k < segments; ++k) {
+                const double angle = 2 * PI * k / segments;
+                circle.points.push_back(Point(pillar.x + radius * cos(angle), pillar.y + radius * sin(angle)));
+            }
+            pp.push_back(circle);
+        }
+    }
+    
+    return union_ex(pp);
+}
+
 coordf_t
 SLAPrint::sm_pillars_radius() const
 {
@@ -316,6 +610,16 @@ SLAPrint::sm_pillars_radius() const
     return radius;
 }
 
+coordf_t
+SLAPrint::sm_pillar_radius(const SupportPillar &pillar, size_t i) const
+{
+    // generate a conic tip
+    return std::min(
+        this->sm_pillars_radius(),
+        (pillar.top_layer - i + 1) * this->config.layer_height.value
+    );
+}
+
 std::string
 SLAPrint::_SVG_path_d(const Polygon &polygon) const
 {
@@ -9,6 +9,9 @@
 #include "Point.hpp"
 #include "PrintConfig.hpp"
 #include "SVG.hpp"
+#include <map>
+#include <memory>
+#include <boost/thread.hpp>
 
 namespace Slic3r {
 
@@ -41,13 +44,41 @@ class SLAPrint
     SLAPrint(const Model* _model) : model(_model) {};
     void slice();
     void write_svg(const std::string &outputfile) const;
+    /// Rasterize each layer into a grayscale PNG image and store them
+    /// in a zip archive, in layer order.
+    void write_png(const std::string &outputfile) const;
     
     private:
+    /// Internal infill lines covering the whole object, shared by all the layers
+    /// filled with the same angle and density.
+    class FillPattern {
+        public:
+        Polylines polylines;
+        /// Spacing of the lines, as returned by Fill::spacing().
+        coordf_t spacing;
+        
+        FillPattern(const Polylines &polylines, coordf_t spacing);
+        /// Parts of the lines inside the expolygon. The edges of the expolygon
+        /// are indexed by a grid, so that each segment is only intersected with
+        /// the edges next to it. All the lines must start outside the expolygon.
+        Polylines clip(const ExPolygon &expolygon) const;
+        
+        private:
+        std::vector<BoundingBox> bboxes;
+    };
+    
     const Model* model;
     BoundingBoxf3 bb;
+    /// Infill patterns by angle and density.
+    std::map< std::pair<float,float>, std::shared_ptr<const FillPattern> > fill_patterns;
+    boost::mutex fill_patterns_mutex;
     
     void _infill_layer(size_t i, const Fill* fill);
+    const FillPattern& _fill_pattern(const Fill &fill);
+    void _generate_pillars(const Points &pillars_pos);
     coordf_t sm_pillars_radius() const;
+    coordf_t sm_pillar_radius(const SupportPillar &pillar, size_t i) const;
+    ExPolygons _layer_shapes(size_t i) const;
     std::string _SVG_path_d(const Polygon &polygon) const;
     std::string _SVG_path_d(const ExPolygon &expolygon) const;
 };
@@ -852,12 +852,9 @@ SupportMaterial::clip_with_shape(map<int, Polygons> &support, map<int, Polygons>
 void
 SupportMaterial::clip_with_object(map<int, Polygons> &support, vector<coordf_t> support_z, PrintObject &object)
 {
-    int i = 0;
-    for (auto support_layer: support) {
-        if (support_layer.second.empty()) {
-            i++;
-            continue;
-        }
+    for (auto &support_layer : support) {
+        if (support_layer.second.empty()) continue;
+        const int i = support_layer.first;
         coordf_t z_max = support_z[i];
         coordf_t z_min = (i == 0) ? 0 : support_z[i - 1];
 
@@ -878,7 +875,7 @@ SupportMaterial::clip_with_object(map<int, Polygons> &support, vector<coordf_t>
                 slices.push_back(s);
             }
         }
-        support_layer.second = diff(support_layer.second, offset(slices, flow.scaled_width()));
+        support_layer.second = diff_partitioned(support_layer.second, offset(slices, flow.scaled_width()));
     }
     /*
         $support->{$i} = diff(
@@ -8,6 +8,7 @@
 #include <set>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <utility>
 #include <algorithm>
 #include <math.h>
@@ -512,51 +513,56 @@ void TriangleMesh::cut(Axis axis, double z, TriangleMesh* upper, TriangleMesh* l
 TriangleMeshPtrs
 TriangleMesh::split() const
 {
-    TriangleMeshPtrs meshes;
-    std::set<int> seen_facets;
-    
     // we need neighbors
     if (!this->repaired) CONFESS("split() requires repair()");
     
-    // loop while we have remaining facets
-    while (1) {
-        // get the first facet
-        std::queue<int> facet_queue;
-        std::deque<int> facets;
-        for (int facet_idx = 0; facet_idx < this->stl.stats.number_of_facets; facet_idx++) {
-            if (seen_facets.find(facet_idx) == seen_facets.end()) {
-                // if facet was not seen put it into queue and start searching
-                facet_queue.push(facet_idx);
-                break;
-            }
-        }
-        if (facet_queue.empty()) break;
-        
-        while (!facet_queue.empty()) {
-            int facet_idx = facet_queue.front();
-            facet_queue.pop();
-            if (seen_facets.find(facet_idx) != seen_facets.end()) continue;
-            facets.push_back(facet_idx);
+    // label each facet with its connected component, flooding every component
+    // from its first facet so that each facet is visited once
+    const int number_of_facets = this->stl.stats.number_of_facets;
+    std::vector<int> component(number_of_facets, -1);
+    std::vector<int> component_size;
+    std::vector<int> facet_stack;
+    for (int first_facet = 0; first_facet < number_of_facets; first_facet++) {
+        if (component[first_facet] != -1) continue;
+        const int component_idx = component_size.size();
+        int size = 0;
+        component[first_facet] = component_idx;
+        facet_stack.push_back(first_facet);
+        while (!facet_stack.empty()) {
+            const int facet_idx = facet_stack.back();
+            facet_stack.pop_back();
+            ++size;
             for (int j = 0; j <= 2; j++) {
-                facet_queue.push(this->stl.neighbors_start[facet_idx].neighbor[j]);
+                const int neighbor = this->stl.neighbors_start[facet_idx].neighbor[j];
+                if (neighbor >= 0 && component[neighbor] == -1) {
+                    component[neighbor] = component_idx;
+                    facet_stack.push_back(neighbor);
+                }
             }
-            seen_facets.insert(facet_idx);
         }
-        
+        component_size.push_back(size);
+    }
+    
+    // allocate each mesh once, then distribute the facets in a single pass
+    TriangleMeshPtrs meshes;
+    meshes.reserve(component_size.size());
+    for (std::vector<int>::const_iterator size = component_size.begin(); size != component_size.end(); ++size) {
         TriangleMesh* mesh = new TriangleMesh;
         meshes.push_back(mesh);
         mesh->stl.stats.type = inmemory;
-        mesh->stl.stats.number_of_facets = facets.size();
+        mesh->stl.stats.number_of_facets = *size;
         mesh->stl.stats.original_num_facets = mesh->stl.stats.number_of_facets;
         stl_clear_error(&mesh->stl);
         stl_allocate(&mesh->stl);
-        
-        int first = 1;
-        for (std::deque<int>::const_iterator facet = facets.begin(); facet != facets.end(); ++facet) {
-            mesh->stl.facet_start[facet - facets.begin()] = this->stl.facet_start[*facet];
-            stl_facet_stats(&mesh->stl, this->stl.facet_start[*facet], first);
-            first = 0;
-        }
+    }
+    
+    std::vector<int> facets_copied(meshes.size(), 0);
+    for (int facet_idx = 0; facet_idx < number_of_facets; facet_idx++) {
+        TriangleMesh* mesh = meshes[component[facet_idx]];
+        int &idx = facets_copied[component[facet_idx]];
+        mesh->stl.facet_start[idx] = this->stl.facet_start[facet_idx];
+        stl_facet_stats(&mesh->stl, this->stl.facet_start[facet_idx], idx == 0);
+        ++idx;
     }
     
     return meshes;
@@ -572,34 +578,33 @@ TriangleMesh::cut_by_grid(const Pointf &grid) const
     const size_t y_parts = ceil((size.y - EPSILON)/grid.y);
     
     TriangleMeshPtrs meshes;
-    for (size_t i = 1; i <= x_parts; ++i) {
-        TriangleMesh curr;
-        if (i == x_parts) {
-            curr = mesh;
+    if (x_parts == 0 || y_parts == 0) return meshes;
+    
+    std::vector<float> x_planes, y_planes;
+    for (size_t i = 1; i < x_parts; ++i)
+        x_planes.push_back(bb.min.x + (grid.x * i));
+    for (size_t j = 1; j < y_parts; ++j)
+        y_planes.push_back(bb.min.y + (grid.y * j));
+    
+    // cut the mesh into columns along X, then each column into tiles along Y,
+    // each of them with a single sweep over the facets
+    TriangleMeshPtrs columns;
+    TriangleMeshSlicer<X>(&mesh).cut(x_planes, &columns);
+    
+    meshes.reserve(x_parts * y_parts);
+    for (TriangleMeshPtrs::iterator column = columns.begin(); column != columns.end(); ++column) {
+        (*column)->repair();
+        if ((*column)->facets_count() == 0) {
+            for (size_t j = 0; j < y_parts; ++j)
+                meshes.push_back(new TriangleMesh);
         } else {
-            TriangleMesh next;
-            TriangleMeshSlicer<X>(&mesh).cut(bb.min.x + (grid.x * i), &next, &curr);
-            curr.repair();
-            next.repair();
-            mesh = next;
-        }
-        
-        for (size_t j = 1; j <= y_parts; ++j) {
-            TriangleMesh* tile;
-            if (j == y_parts) {
-                tile = new TriangleMesh(curr);
-            } else {
-                TriangleMesh next;
-                tile = new TriangleMesh;
-                TriangleMeshSlicer<Y>(&curr).cut(bb.min.y + (grid.y * j), &next, tile);
-                tile->repair();
-                next.repair();
-                curr = next;
-            }
-            
-            meshes.push_back(tile);
+            TriangleMeshSlicer<Y>(*column).cut(y_planes, &meshes);
         }
+        delete *column;
     }
+    for (TriangleMeshPtrs::iterator tile = meshes.begin(); tile != meshes.end(); ++tile)
+        (*tile)->repair();
+    
     return meshes;
 }
 
@@ -628,21 +633,112 @@ TriangleMesh::merge(const TriangleMesh &mesh)
 ExPolygons
 TriangleMesh::horizontal_projection() const
 {
-    Polygons pp;
-    pp.reserve(this->stl.stats.number_of_facets);
+    // the offset factor was tuned using groovemount.stl
+    const float delta = 0.01 / SCALING_FACTOR;
+    
+    if (this->stl.v_shared == NULL || this->stl.v_indices == NULL)
+        return this->_horizontal_projection_by_facets(delta);
+    
+    // Once every facet is oriented counter-clockwise in projection, the winding number
+    // of the sum of their boundaries counts the facets covering each point. Edges shared
+    // by two facets cancel out, so only the silhouette edges (between facets facing up
+    // and facets facing down, or along open borders) remain, and the nonzero union of
+    // the loops they form is the union of all the facets.
+    Points points;
+    points.reserve(this->stl.stats.shared_vertices);
+    for (int i = 0; i < this->stl.stats.shared_vertices; i++) {
+        const stl_vertex &v = this->stl.v_shared[i];
+        points.push_back(Point(v.x / SCALING_FACTOR, v.y / SCALING_FACTOR));
+    }
+    
+    // net count of the edges oriented from the lower vertex index to the higher one
+    std::unordered_map<uint64_t,int> edges;
+    edges.reserve(this->stl.stats.number_of_facets);
     for (int i = 0; i < this->stl.stats.number_of_facets; i++) {
-        stl_facet* facet = &this->stl.facet_start[i];
-        Polygon p;
-        p.points.resize(3);
-        p.points[0] = Point(facet->vertex[0].x / SCALING_FACTOR, facet->vertex[0].y / SCALING_FACTOR);
-        p.points[1] = Point(facet->vertex[1].x / SCALING_FACTOR, facet->vertex[1].y / SCALING_FACTOR);
-        p.points[2] = Point(facet->vertex[2].x / SCALING_FACTOR, facet->vertex[2].y / SCALING_FACTOR);
-        p.make_counter_clockwise();  // do this after scaling, as winding order might change while doing that
-        pp.push_back(p);
+        int v[3] = { this->stl.v_indices[i].vertex[0], this->stl.v_indices[i].vertex[1], this->stl.v_indices[i].vertex[2] };
+        const Point &a = points[v[0]], &b = points[v[1]], &c = points[v[2]];
+        const double area = double(b.x - a.x) * double(c.y - a.y) - double(c.x - a.x) * double(b.y - a.y);
+        if (area == 0) continue;  // vertical facet, it adds nothing to the projection
+        if (area < 0) std::swap(v[1], v[2]);
+        for (int j = 0; j <= 2; j++) {
+            const int from = v[j], to = v[(j+1) % 3];
+            if (from < to)
+                ++edges[(uint64_t(from) << 32) | uint64_t(to)];
+            else
+                --edges[(uint64_t(to) << 32) | uint64_t(from)];
+        }
     }
     
-    // the offset factor was tuned using groovemount.stl
-    return union_ex(offset(pp, 0.01 / SCALING_FACTOR), true);
+    // directed silhouette edges sorted by their first vertex
+    std::vector< std::pair<int,int> > silhouette;
+    for (std::unordered_map<uint64_t,int>::const_iterator edge = edges.begin(); edge != edges.end(); ++edge) {
+        const int a = int(edge->first >> 32), b = int(edge->first & 0xffffffff);
+        for (int n = 0; n < std::abs(edge->second); ++n)
+            silhouette.push_back(edge->second > 0 ? std::make_pair(a, b) : std::make_pair(b, a));
+    }
+    std::sort(silhouette.begin(), silhouette.end());
+    std::vector<size_t> next_edge(points.size() + 1, silhouette.size());
+    for (size_t i = silhouette.size(); i > 0; --i)
+        next_edge[silhouette[i-1].first] = i-1;
+    for (size_t i = points.size(); i > 0; --i)
+        next_edge[i-1] = std::min(next_edge[i-1], next_edge[i]);
+    
+    // chain the edges into loops: every vertex has as many edges leaving it as
+    // edges reaching it, so a walk always gets back to its first vertex
+    Polygons loops;
+    std::vector<bool> used(silhouette.size(), false);
+    for (size_t i = 0; i < silhouette.size(); ++i) {
+        if (used[i]) continue;
+        Polygon loop;
+        for (size_t edge = i; edge < silhouette.size() && !used[edge]; ) {
+            used[edge] = true;
+            loop.points.push_back(points[silhouette[edge].first]);
+            const int v = silhouette[edge].second;
+            if (v == silhouette[i].first) break;
+            for (edge = next_edge[v]; edge < silhouette.size() && silhouette[edge].first == v && used[edge]; ++edge) ;
+            if (edge == silhouette.size() || silhouette[edge].first != v) break;
+            next_edge[v] = edge;
+        }
+        loops.push_back(loop);
+    }
+    
+    return union_ex(offset(union_(loops), delta), true);
+}
+
+/// Projection of meshes without shared vertices: the facets are offset and merged
+/// in chunks in parallel, then the partial unions are merged pairwise.
+ExPolygons
+TriangleMesh::_horizontal_projection_by_facets(float delta) const
+{
+    const size_t chunk_size = 1000;
+    const size_t number_of_facets = this->stl.stats.number_of_facets;
+    if (number_of_facets == 0) return ExPolygons();
+    
+    std::vector<Polygons> parts((number_of_facets + chunk_size - 1) / chunk_size);
+    parallelize<size_t>(0, parts.size() - 1, [this, &parts, chunk_size, number_of_facets, delta](size_t part) {
+        Polygons pp;
+        pp.reserve(chunk_size);
+        for (size_t i = part * chunk_size; i < std::min(number_of_facets, (part + 1) * chunk_size); i++) {
+            const stl_facet* facet = &this->stl.facet_start[i];
+            Polygon p;
+            p.points.resize(3);
+            p.points[0] = Point(facet->vertex[0].x / SCALING_FACTOR, facet->vertex[0].y / SCALING_FACTOR);
+            p.points[1] = Point(facet->vertex[1].x / SCALING_FACTOR, facet->vertex[1].y / SCALING_FACTOR);
+            p.points[2] = Point(facet->vertex[2].x / SCALING_FACTOR, facet->vertex[2].y / SCALING_FACTOR);
+            p.make_counter_clockwise();  // do this after scaling, as winding order might change while doing that
+            pp.push_back(p);
+        }
+        parts[part] = union_(offset(pp, delta));
+    });
+    
+    while (parts.size() > 1) {
+        std::vector<Polygons> merged((parts.size() + 1) / 2);
+        parallelize<size_t>(0, merged.size() - 1, [&parts, &merged](size_t i) {
+            merged[i] = (2*i + 1 < parts.size()) ? union_(parts[2*i], parts[2*i + 1]) : parts[2*i];
+        });
+        parts.swap(merged);
+    }
+    return union_ex(parts.front(), true);
 }
 
 Polygon
@@ -1388,11 +1484,66 @@ TriangleMeshSlicer<A>::make_expolygons(std::vector<IntersectionLine> &lines, ExP
     this->make_expolygons(pp, slices);
 }
 
+/// Dispatch the intersection lines of a facet with a cutting plane to the
+/// sections of the upper and lower halves.
+static void
+sort_cut_lines(const IntersectionLines &lines, IntersectionLines* upper_lines, IntersectionLines* lower_lines)
+{
+    // save intersection lines for generating correct triangulations
+    for (IntersectionLines::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+        if (it->edge_type == feTop) {
+            lower_lines->push_back(*it);
+        } else if (it->edge_type == feBottom) {
+            upper_lines->push_back(*it);
+        } else if (it->edge_type != feHorizontal) {
+            lower_lines->push_back(*it);
+            upper_lines->push_back(*it);
+        }
+    }
+}
+
+/// Triangulate a convex polygon as a fan around its first vertex.
+static void
+append_fan(const std::vector<stl_vertex> &polygon, const stl_normal &normal, std::vector<stl_facet>* facets)
+{
+    for (size_t i = 2; i < polygon.size(); ++i) {
+        stl_facet facet;
+        facet.normal = normal;
+        facet.vertex[0] = polygon.front();
+        facet.vertex[1] = polygon[i-1];
+        facet.vertex[2] = polygon[i];
+        facets->push_back(facet);
+    }
+}
+
+/// Replace the facets of a mesh with the given ones using a single allocation.
+/// Facets are stored the way stl_add_facet() stores them.
+static void
+stl_set_facets(stl_file* stl, const std::vector<stl_facet> &facets)
+{
+    stl->stats.type = inmemory;
+    stl->stats.number_of_facets = facets.size();
+    stl->stats.original_num_facets = stl->stats.number_of_facets;
+    stl->stats.facets_added = stl->stats.number_of_facets;
+    stl_clear_error(stl);
+    stl_allocate(stl);
+    for (size_t i = 0; i < facets.size(); ++i) {
+        stl->facet_start[i] = facets[i];
+        stl->facet_start[i].normal.x = 0.0;
+        stl->facet_start[i].normal.y = 0.0;
+        stl->facet_start[i].normal.z = 0.0;
+        for (int j = 0; j <= 2; ++j)
+            stl->neighbors_start[i].neighbor[j] = -1;
+    }
+    stl_get_size(stl);
+}
+
 template <Axis A>
 void
 TriangleMeshSlicer<A>::cut(float z, TriangleMesh* upper, TriangleMesh* lower) const
 {
     IntersectionLines upper_lines, lower_lines;
+    std::vector<stl_facet> upper_facets, lower_facets;
     
     const float scaled_z = scale_(z);
     for (int facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; facet_idx++) {
@@ -1405,146 +1556,203 @@ TriangleMeshSlicer<A>::cut(float z, TriangleMesh* upper, TriangleMesh* lower) co
         // intersect facet with cutting plane
         IntersectionLines lines;
         this->slice_facet(scaled_z, *facet, facet_idx, min_z, max_z, &lines);
+        sort_cut_lines(lines, &upper_lines, &lower_lines);
         
-        // save intersection lines for generating correct triangulations
-        for (IntersectionLines::const_iterator it = lines.begin(); it != lines.end(); ++it) {
-            if (it->edge_type == feTop) {
-                lower_lines.push_back(*it);
-            } else if (it->edge_type == feBottom) {
-                upper_lines.push_back(*it);
-            } else if (it->edge_type != feHorizontal) {
-                lower_lines.push_back(*it);
-                upper_lines.push_back(*it);
-            }
+        this->_cut_facet(z, *facet, upper == NULL ? NULL : &upper_facets, lower == NULL ? NULL : &lower_facets);
+    }
+    
+    // triangulate holes of upper and lower mesh
+    if (upper != NULL) {
+        this->_make_cap(z, upper_lines, true, &upper_facets);
+        for (std::vector<stl_facet>::iterator facet = upper_facets.begin(); facet != upper_facets.end(); ++facet)
+            stl_add_facet(&upper->stl, &*facet);
+        stl_get_size(&(upper->stl));
+    }
+    if (lower != NULL) {
+        this->_make_cap(z, lower_lines, false, &lower_facets);
+        for (std::vector<stl_facet>::iterator facet = lower_facets.begin(); facet != lower_facets.end(); ++facet)
+            stl_add_facet(&lower->stl, &*facet);
+        stl_get_size(&(lower->stl));
+    }
+}
+
+template <Axis A>
+void
+TriangleMeshSlicer<A>::cut(const std::vector<float> &z, TriangleMeshPtrs* parts) const
+{
+    // facets of each slab, slab i lying between z[i-1] and z[i]
+    std::vector< std::vector<stl_facet> > slabs(z.size() + 1);
+    std::vector<IntersectionLines> upper_lines(z.size()), lower_lines(z.size());
+    
+    std::vector<stl_vertex> polygon, below, above;
+    for (int facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; facet_idx++) {
+        const stl_facet &facet = this->mesh->stl.facet_start[facet_idx];
+        
+        // find facet extents
+        const float min_z = fminf(_z(facet.vertex[0]), fminf(_z(facet.vertex[1]), _z(facet.vertex[2])));
+        const float max_z = fmaxf(_z(facet.vertex[0]), fmaxf(_z(facet.vertex[1]), _z(facet.vertex[2])));
+        
+        // planes touching the facet are in [first, last)
+        const size_t first = std::lower_bound(z.begin(), z.end(), min_z) - z.begin();
+        const size_t last  = std::upper_bound(z.begin() + first, z.end(), max_z) - z.begin();
+        if (first == last) {
+            // facet is entirely inside a slab
+            slabs[first].push_back(facet);
+            continue;
         }
         
-        if (min_z > z || (min_z == z && max_z > min_z)) {
-            // facet is above the cut plane and does not belong to it
-            if (upper != NULL) stl_add_facet(&upper->stl, facet);
-        } else if (max_z < z || (max_z == z && max_z > min_z)) {
-            // facet is below the cut plane and does not belong to it
-            if (lower != NULL) stl_add_facet(&lower->stl, facet);
-        } else if (min_z < z && max_z > z) {
-            // facet is cut by the slicing plane
-            
-            // look for the vertex on whose side of the slicing plane there are no other vertices
-            int isolated_vertex;
-            if ( (_z(facet->vertex[0]) > z) == (_z(facet->vertex[1]) > z) ) {
-                isolated_vertex = 2;
-            } else if ( (_z(facet->vertex[1]) > z) == (_z(facet->vertex[2]) > z) ) {
-                isolated_vertex = 0;
-            } else {
-                isolated_vertex = 1;
-            }
-            
-            // get vertices starting from the isolated one
-            stl_vertex* v0 = &facet->vertex[isolated_vertex];
-            stl_vertex* v1 = &facet->vertex[(isolated_vertex+1) % 3];
-            stl_vertex* v2 = &facet->vertex[(isolated_vertex+2) % 3];
-            
-            // intersect v0-v1 and v2-v0 with cutting plane and make new vertices
-            stl_vertex v0v1, v2v0;
-            _x(v0v1) = _x(*v1) + (_x(*v0) - _x(*v1)) * (z - _z(*v1)) / (_z(*v0) - _z(*v1));
-            _y(v0v1) = _y(*v1) + (_y(*v0) - _y(*v1)) * (z - _z(*v1)) / (_z(*v0) - _z(*v1));
-            _z(v0v1) = z;
-            _x(v2v0) = _x(*v2) + (_x(*v0) - _x(*v2)) * (z - _z(*v2)) / (_z(*v0) - _z(*v2));
-            _y(v2v0) = _y(*v2) + (_y(*v0) - _y(*v2)) * (z - _z(*v2)) / (_z(*v0) - _z(*v2));
-            _z(v2v0) = z;
-            
-            // build the triangular facet
-            stl_facet triangle;
-            triangle.normal = facet->normal;
-            triangle.vertex[0] = *v0;
-            triangle.vertex[1] = v0v1;
-            triangle.vertex[2] = v2v0;
-            
-            // build the facets forming a quadrilateral on the other side
-            stl_facet quadrilateral[2];
-            quadrilateral[0].normal = facet->normal;
-            quadrilateral[0].vertex[0] = *v1;
-            quadrilateral[0].vertex[1] = *v2;
-            quadrilateral[0].vertex[2] = v0v1;
-            quadrilateral[1].normal = facet->normal;
-            quadrilateral[1].vertex[0] = *v2;
-            quadrilateral[1].vertex[1] = v2v0;
-            quadrilateral[1].vertex[2] = v0v1;
+        // horizontal facets lying on a cutting plane belong to no slab
+        if (min_z == max_z) continue;
+        
+        // clip the facet with each plane from the bottom up: the part below the plane
+        // goes to the slab, the part above is carried over to the next plane.
+        // Cutting the polygon rather than triangles keeps the new edges inside their
+        // slab, so that the sides get vertices on a plane only where the original
+        // edges cross it, as the sections do.
+        polygon.assign(facet.vertex, facet.vertex + 3);
+        for (size_t i = first; i < last; ++i) {
+            IntersectionLines lines;
+            this->slice_facet(scale_(z[i]), facet, facet_idx, min_z, max_z, &lines);
+            sort_cut_lines(lines, &upper_lines[i], &lower_lines[i]);
             
-            if (_z(*v0) > z) {
-                if (upper != NULL) stl_add_facet(&upper->stl, &triangle);
-                if (lower != NULL) {
-                    stl_add_facet(&lower->stl, &quadrilateral[0]);
-                    stl_add_facet(&lower->stl, &quadrilateral[1]);
+            below.clear();
+            above.clear();
+            for (size_t j = 0; j < polygon.size(); ++j) {
+                const stl_vertex &a = polygon[j];
+                const stl_vertex &b = polygon[(j+1) % polygon.size()];
+                if (_z(a) <= z[i]) below.push_back(a);
+                if (_z(a) >= z[i]) above.push_back(a);
+                if ((_z(a) < z[i] && _z(b) > z[i]) || (_z(a) > z[i] && _z(b) < z[i])) {
+                    // interpolate from the lower end, so that both facets sharing the edge get the same point
+                    const stl_vertex &lo = (_z(a) < _z(b)) ? a : b;
+                    const stl_vertex &hi = (_z(a) < _z(b)) ? b : a;
+                    stl_vertex v;
+                    _x(v) = _x(lo) + (_x(hi) - _x(lo)) * (z[i] - _z(lo)) / (_z(hi) - _z(lo));
+                    _y(v) = _y(lo) + (_y(hi) - _y(lo)) * (z[i] - _z(lo)) / (_z(hi) - _z(lo));
+                    _z(v) = z[i];
+                    below.push_back(v);
+                    above.push_back(v);
                 }
-            } else {
-                if (upper != NULL) {
-                    stl_add_facet(&upper->stl, &quadrilateral[0]);
-                    stl_add_facet(&upper->stl, &quadrilateral[1]);
-                }
-                if (lower != NULL) stl_add_facet(&lower->stl, &triangle);
             }
+            append_fan(below, facet.normal, &slabs[i]);
+            polygon.swap(above);
         }
+        append_fan(polygon, facet.normal, &slabs[last]);
     }
     
-    // triangulate holes of upper mesh
-    if (upper != NULL) {
-        // compute shape of section
-        ExPolygons section;
-        this->make_expolygons_simple(upper_lines, &section);
-        
-        // triangulate section
-        Polygons triangles;
-        for (ExPolygons::const_iterator expolygon = section.begin(); expolygon != section.end(); ++expolygon)
-            expolygon->triangulate_p2t(&triangles);
-        
-        // convert triangles to facets and append them to mesh
-        for (Polygons::const_iterator polygon = triangles.begin(); polygon != triangles.end(); ++polygon) {
-            Polygon p = *polygon;
-            p.reverse();
-            stl_facet facet;
-            _x(facet.normal) = 0;
-            _y(facet.normal) = 0;
-            _z(facet.normal) = -1;
-            for (size_t i = 0; i <= 2; ++i) {
-                _x(facet.vertex[i]) = unscale(p.points[i].x);
-                _y(facet.vertex[i]) = unscale(p.points[i].y);
-                _z(facet.vertex[i]) = z;
-            }
-            stl_add_facet(&upper->stl, &facet);
-        }
+    // close each slab with the sections of the planes bounding it
+    for (size_t i = 0; i < z.size(); ++i) {
+        this->_make_cap(z[i], lower_lines[i], false, &slabs[i]);
+        this->_make_cap(z[i], upper_lines[i], true, &slabs[i+1]);
     }
     
-    // triangulate holes of lower mesh
-    if (lower != NULL) {
-        // compute shape of section
-        ExPolygons section;
-        this->make_expolygons_simple(lower_lines, &section);
+    parts->reserve(parts->size() + slabs.size());
+    for (std::vector< std::vector<stl_facet> >::const_iterator slab = slabs.begin(); slab != slabs.end(); ++slab) {
+        TriangleMesh* part = new TriangleMesh;
+        stl_set_facets(&part->stl, *slab);
+        parts->push_back(part);
+    }
+}
+
+template <Axis A>
+void
+TriangleMeshSlicer<A>::_cut_facet(float z, const stl_facet &facet, std::vector<stl_facet>* upper, std::vector<stl_facet>* lower) const
+{
+    // find facet extents
+    const float min_z = fminf(_z(facet.vertex[0]), fminf(_z(facet.vertex[1]), _z(facet.vertex[2])));
+    const float max_z = fmaxf(_z(facet.vertex[0]), fmaxf(_z(facet.vertex[1]), _z(facet.vertex[2])));
+    
+    if (min_z > z || (min_z == z && max_z > min_z)) {
+        // facet is above the cut plane and does not belong to it
+        if (upper != NULL) upper->push_back(facet);
+    } else if (max_z < z || (max_z == z && max_z > min_z)) {
+        // facet is below the cut plane and does not belong to it
+        if (lower != NULL) lower->push_back(facet);
+    } else if (min_z < z && max_z > z) {
+        // facet is cut by the slicing plane
+        
+        // look for the vertex on whose side of the slicing plane there are no other vertices
+        int isolated_vertex;
+        if ( (_z(facet.vertex[0]) > z) == (_z(facet.vertex[1]) > z) ) {
+            isolated_vertex = 2;
+        } else if ( (_z(facet.vertex[1]) > z) == (_z(facet.vertex[2]) > z) ) {
+            isolated_vertex = 0;
+        } else {
+            isolated_vertex = 1;
+        }
         
-        // triangulate section
-        Polygons triangles;
-        for (ExPolygons::const_iterator expolygon = section.begin(); expolygon != section.end(); ++expolygon)
-            expolygon->triangulate_p2t(&triangles);
+        // get vertices starting from the isolated one
+        const stl_vertex* v0 = &facet.vertex[isolated_vertex];
+        const stl_vertex* v1 = &facet.vertex[(isolated_vertex+1) % 3];
+        const stl_vertex* v2 = &facet.vertex[(isolated_vertex+2) % 3];
         
-        // convert triangles to facets and append them to mesh
-        for (Polygons::const_iterator polygon = triangles.begin(); polygon != triangles.end(); ++polygon) {
-            stl_facet facet;
-            _x(facet.normal) = 0;
-            _y(facet.normal) = 0;
-            _z(facet.normal) = 1;
-            for (size_t i = 0; i <= 2; ++i) {
-                _x(facet.vertex[i]) = unscale(polygon->points[i].x);
-                _y(facet.vertex[i]) = unscale(polygon->points[i].y);
-                _z(facet.vertex[i]) = z;
-            }
-            stl_add_facet(&lower->stl, &facet);
+        // intersect v0-v1 and v2-v0 with cutting plane and make new vertices
+        stl_vertex v0v1, v2v0;
+        _x(v0v1) = _x(*v1) + (_x(*v0) - _x(*v1)) * (z - _z(*v1)) / (_z(*v0) - _z(*v1));
+        _y(v0v1) = _y(*v1) + (_y(*v0) - _y(*v1)) * (z - _z(*v1)) / (_z(*v0) - _z(*v1));
+        _z(v0v1) = z;
+        _x(v2v0) = _x(*v2) + (_x(*v0) - _x(*v2)) * (z - _z(*v2)) / (_z(*v0) - _z(*v2));
+        _y(v2v0) = _y(*v2) + (_y(*v0) - _y(*v2)) * (z - _z(*v2)) / (_z(*v0) - _z(*v2));
+        _z(v2v0) = z;
+        
+        // build the triangular facet
+        stl_facet triangle;
+        triangle.normal = facet.normal;
+        triangle.vertex[0] = *v0;
+        triangle.vertex[1] = v0v1;
+        triangle.vertex[2] = v2v0;
+        
+        // build the facets forming a quadrilateral on the other side
+        stl_facet quadrilateral[2];
+        quadrilateral[0].normal = facet.normal;
+        quadrilateral[0].vertex[0] = *v1;
+        quadrilateral[0].vertex[1] = *v2;
+        quadrilateral[0].vertex[2] = v0v1;
+        quadrilateral[1].normal = facet.normal;
+        quadrilateral[1].vertex[0] = *v2;
+        quadrilateral[1].vertex[1] = v2v0;
+        quadrilateral[1].vertex[2] = v0v1;
+        
+        std::vector<stl_facet>* triangle_side      = (_z(*v0) > z) ? upper : lower;
+        std::vector<stl_facet>* quadrilateral_side = (_z(*v0) > z) ? lower : upper;
+        if (triangle_side != NULL) triangle_side->push_back(triangle);
+        if (quadrilateral_side != NULL) {
+            quadrilateral_side->push_back(quadrilateral[0]);
+            quadrilateral_side->push_back(quadrilateral[1]);
         }
     }
+}
+
+template <Axis A>
+void
+TriangleMeshSlicer<A>::_make_cap(float z, std::vector<IntersectionLine> &lines, bool upper, std::vector<stl_facet>* facets) const
+{
+    // compute shape of section
+    ExPolygons section;
+    this->make_expolygons_simple(lines, &section);
     
+    // triangulate section
+    Polygons triangles;
+    for (ExPolygons::const_iterator expolygon = section.begin(); expolygon != section.end(); ++expolygon)
+        expolygon->triangulate_p2t(&triangles);
     
-    stl_get_size(&(upper->stl));
-    stl_get_size(&(lower->stl));
+    // convert triangles to facets, facing down for the upper mesh and up for the lower one
+    facets->reserve(facets->size() + triangles.size());
+    for (Polygons::iterator polygon = triangles.begin(); polygon != triangles.end(); ++polygon) {
+        if (upper) polygon->reverse();
+        stl_facet facet;
+        _x(facet.normal) = 0;
+        _y(facet.normal) = 0;
+        _z(facet.normal) = upper ? -1 : 1;
+        for (size_t i = 0; i <= 2; ++i) {
+            _x(facet.vertex[i]) = unscale(polygon->points[i].x);
+            _y(facet.vertex[i]) = unscale(polygon->points[i].y);
+            _z(facet.vertex[i]) = z;
+        }
+        facets->push_back(facet);
+    }
 }
 
-
 template <Axis A>
 TriangleMeshSlicer<A>::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_scaled_shared(NULL)
 {
@@ -89,6 +89,9 @@ class TriangleMesh
     TriangleMeshPtrs split() const;
     TriangleMeshPtrs cut_by_grid(const Pointf &grid) const;
     void merge(const TriangleMesh &mesh);
+    /// Scaled projection of the mesh on the XY plane. It is built from the silhouette
+    /// edges when shared vertices are available (see require_shared_vertices()),
+    /// which is much cheaper than merging every facet.
     ExPolygons horizontal_projection() const;
     Polygon convex_hull();
     BoundingBoxf3 bounding_box() const;
@@ -154,6 +157,9 @@ class TriangleMesh
     /// Perform the mechanics of a stl copy
     void clone(const TriangleMesh& other);
 
+    /// Fallback of horizontal_projection() for meshes without shared vertices.
+    ExPolygons _horizontal_projection_by_facets(float delta) const;
+
     friend class TriangleMeshSlicer<X>;
     friend class TriangleMeshSlicer<Y>;
     friend class TriangleMeshSlicer<Z>;
@@ -205,6 +211,11 @@ class TriangleMeshSlicer
 	/// \param[out] lower TriangleMesh object to save the mesh < z. NULL suppresses saving this.
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower) const;
     
+	/// \brief Splits the current mesh into slabs along several parallel planes in a single pass.
+	/// \param[in] z Coordinates of the cutting planes, in ascending order.
+	/// \param[out] parts Receives z.size()+1 new meshes, from the lowest slab to the highest one.
+    void cut(const std::vector<float> &z, TriangleMeshPtrs* parts) const;
+    
     private:
     typedef std::vector< std::vector<int> > t_facets_edges;
     t_facets_edges facets_edges;
@@ -215,6 +226,8 @@ class TriangleMeshSlicer
     void make_expolygons(const Polygons &loops, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
     void make_expolygons(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
+    void _cut_facet(float z, const stl_facet &facet, std::vector<stl_facet>* upper, std::vector<stl_facet>* lower) const;
+    void _make_cap(float z, std::vector<IntersectionLine> &lines, bool upper, std::vector<stl_facet>* facets) const;
     
     float& _x(stl_vertex &vertex) const;
     float& _y(stl_vertex &vertex) const;
@@ -11,11 +11,16 @@
 #endif
 
 #include <math.h>
+#include <atomic>
+#include <exception>
+#include <memory>
 #include <queue>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <boost/thread.hpp>
 #include <cstdint>
+#include "Profiler.hpp"
 
 #ifdef _MSC_VER
 #include <limits>
@@ -103,8 +108,30 @@ inline void append_to(std::vector<T> &dst, const std::vector<T> &src)
     dst.insert(dst.end(), src.begin(), src.end());
 }
 
+/// Thrown by a job when its CancellationToken is canceled.
+class CanceledException : public std::runtime_error {
+    public:
+    CanceledException() : std::runtime_error("Canceled") {};
+};
+
+/// Flag telling a running job to stop at its next check.
+/// Copies share the same flag, so a copy can be handed to the thread
+/// which cancels the job while the job checks its own one.
+class CancellationToken {
+    public:
+    CancellationToken() : _canceled(std::make_shared<std::atomic<bool>>(false)) {};
+    void cancel() { *this->_canceled = true; };
+    void reset() { *this->_canceled = false; };
+    bool is_canceled() const { return *this->_canceled; };
+    void throw_if_canceled() const { if (this->is_canceled()) throw CanceledException(); };
+    
+    private:
+    std::shared_ptr<std::atomic<bool>> _canceled;
+};
+
 template <class T> void
-_parallelize_do(std::queue<T>* queue, boost::mutex* queue_mutex, boost::function<void(T)> func)
+_parallelize_do(std::queue<T>* queue, boost::mutex* queue_mutex, std::exception_ptr* error,
+    std::atomic<int64_t>* busy, boost::function<void(T)> func)
 {
     //std::cout << "THREAD STARTED: " << boost::this_thread::get_id() << std::endl;
     while (true) {
@@ -116,21 +143,53 @@ _parallelize_do(std::queue<T>* queue, boost::mutex* queue_mutex, boost::function
             queue->pop();
         }
         //std::cout << "  Thread " << boost::this_thread::get_id() << " processing item " << i << std::endl;
-        func(i);
+        try {
+            if (busy == nullptr) {
+                func(i);
+            } else {
+                // the Profiler measures how long the workers are kept busy
+                const auto t0 = std::chrono::steady_clock::now();
+                func(i);
+                *busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+            }
+        } catch (boost::thread_interrupted &) {
+            throw;
+        } catch (...) {
+            // keep the first error for the caller and drop the pending items
+            // so that the other workers stop after their current one
+            boost::lock_guard<boost::mutex> l(*queue_mutex);
+            if (!*error) *error = std::current_exception();
+            std::queue<T>().swap(*queue);
+            return;
+        }
         boost::this_thread::interruption_point();
     }
 }
 
+/// Run func on every item of the queue using threads_count workers.
+/// An exception thrown by func (a CanceledException, typically) stops
+/// the workers and is rethrown to the caller.
 template <class T> void
 parallelize(std::queue<T> queue, boost::function<void(T)> func,
     int threads_count = boost::thread::hardware_concurrency())
 {
     if (threads_count == 0) threads_count = 2;
     boost::mutex queue_mutex;
+    std::exception_ptr error;
+    const bool profile = Profiler::enabled();
+    std::atomic<int64_t> busy(0);
+    const auto t0 = std::chrono::steady_clock::now();
+    const int workers_count = std::min(threads_count, (int)queue.size());
     boost::thread_group workers;
-    for (int i = 0; i < std::min(threads_count, (int)queue.size()); i++)
-        workers.add_thread(new boost::thread(&_parallelize_do<T>, &queue, &queue_mutex, func));
+    for (int i = 0; i < workers_count; i++)
+        workers.add_thread(new boost::thread(&_parallelize_do<T>, &queue, &queue_mutex, &error,
+            profile ? &busy : nullptr, func));
     workers.join_all();
+    if (profile && workers_count > 0)
+        Profiler::record_parallel(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(),
+            busy * 1e-9, workers_count);
+    if (error) std::rethrow_exception(error);
 }
 
 template <class T> void